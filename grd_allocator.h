@@ -9,6 +9,15 @@
 #include <cstdlib>
 #include <new>
 #include <stdio.h>
+#include <string.h>
+
+#if GRD_OS_WINDOWS
+	#include <malloc.h>
+#elif GRD_OS_DARWIN
+	#include <malloc/malloc.h>
+#elif GRD_OS_LINUX
+	#include <malloc.h>
+#endif
 
 enum GrdAllocatorVerb: s32 {
 	GRD_ALLOCATOR_VERB_ALLOC          = 1 << 0,
@@ -18,8 +27,14 @@ enum GrdAllocatorVerb: s32 {
 	GRD_ALLOCATOR_VERB_FREE_ALLOCATOR = 1 << 4,
 };
 
+// Alignment of memory from GrdMalloc() unless asked for more, same as malloc().
+GRD_DEDUP constexpr u64 GRD_DEFAULT_ALIGNMENT = 16;
+
 struct GrdAllocatorProcResult {
 	void*    data = NULL;
+	// Bytes that may be used at |data|, at least the requested size.
+	// 0 if the allocator doesn't know, then it's the requested size.
+	u64      usable_size = 0;
 	GrdType* allocator_type = NULL;
 };
 
@@ -28,6 +43,9 @@ struct GrdAllocatorProcParams {
 	void*            old_data = 0;
 	u64              old_size = 0;
 	u64              new_size = 0;
+	// Power of two, 0 means the allocator's default.
+	// Realloc must be asked for the same alignment as the allocation was.
+	u64              alignment = 0;
 	GrdCodeLoc       loc;
 };
 
@@ -54,23 +72,68 @@ GRD_DEDUP void grd_free_allocator(GrdAllocator allocator) {
 }
 
 
-GRD_DEDUP void* grd_malloc_crash_on_failure(u64 size) {
-	void* result = malloc(size);
-	if (result) {
-		return result;
-	}
-	fprintf(stderr, "Failed to malloc(%zx)", (size_t) size);
+GRD_DEDUP void grd_crt_out_of_memory(const char* what, void* data, u64 size) {
+	fprintf(stderr, "Failed to %s(%p, %zx)", what, data, (size_t) size);
 	GrdDebugBreak();
 	exit(-1);
 }
-GRD_DEDUP void* grd_realloc_crash_on_failure(void* data, u64 size) {
+
+// Memory of the CRT allocator is always freed with free(), except on Windows,
+//   where all of it comes from _aligned_malloc() to be freed with _aligned_free().
+GRD_DEDUP void* grd_malloc_crash_on_failure(u64 size, u64 alignment = 0) {
+	void* result = NULL;
+#if GRD_OS_WINDOWS
+	result = _aligned_malloc(size, grd_max_u64(alignment, GRD_DEFAULT_ALIGNMENT));
+#else
+	if (alignment <= GRD_DEFAULT_ALIGNMENT) {
+		result = malloc(size);
+	} else if (posix_memalign(&result, alignment, size) != 0) {
+		result = NULL;
+	}
+#endif
+	if (!result) {
+		grd_crt_out_of_memory("malloc", NULL, size);
+	}
+	return result;
+}
+
+GRD_DEDUP void* grd_realloc_crash_on_failure(void* data, u64 old_size, u64 size, u64 alignment = 0) {
+#if GRD_OS_WINDOWS
+	void* result = _aligned_realloc(data, size, grd_max_u64(alignment, GRD_DEFAULT_ALIGNMENT));
+#else
 	void* result = realloc(data, size);
-	if (result) {
-		return result;
+	// realloc() only keeps the default alignment, move it if it's off.
+	if (result && !grd_is_aligned(result, grd_max_u64(alignment, GRD_DEFAULT_ALIGNMENT))) {
+		void* aligned = grd_malloc_crash_on_failure(size, alignment);
+		memcpy(aligned, result, grd_min_u64(old_size, size));
+		free(result);
+		result = aligned;
 	}
-	fprintf(stderr, "Failed to realloc(%p, %zx)", data, (size_t) size);
-	GrdDebugBreak();
-	exit(-1);
+#endif
+	if (!result) {
+		grd_crt_out_of_memory("realloc", data, size);
+	}
+	return result;
+}
+
+GRD_DEDUP void grd_crt_free(void* data) {
+#if GRD_OS_WINDOWS
+	_aligned_free(data);
+#else
+	free(data);
+#endif
+}
+
+GRD_DEDUP u64 grd_crt_usable_size(void* data, u64 alignment) {
+#if GRD_OS_WINDOWS
+	return _aligned_msize(data, grd_max_u64(alignment, GRD_DEFAULT_ALIGNMENT), 0);
+#elif GRD_OS_DARWIN
+	return malloc_size(data);
+#elif GRD_OS_LINUX
+	return malloc_usable_size(data);
+#else
+	return 0;
+#endif
 }
 
 struct GrdCrtAllocator {
@@ -79,12 +142,16 @@ struct GrdCrtAllocator {
 
 GRD_DEDUP GrdAllocatorProcResult grd_c_allocator_proc(void* allocator_data, GrdAllocatorProcParams params) {
 	switch (params.verb) {
-		case GRD_ALLOCATOR_VERB_ALLOC:
-			return { .data = grd_malloc_crash_on_failure(params.new_size) };
-		case GRD_ALLOCATOR_VERB_REALLOC:
-			return { .data = grd_realloc_crash_on_failure(params.old_data, params.new_size) };
+		case GRD_ALLOCATOR_VERB_ALLOC: {
+			void* data = grd_malloc_crash_on_failure(params.new_size, params.alignment);
+			return { .data = data, .usable_size = grd_crt_usable_size(data, params.alignment) };
+		}
+		case GRD_ALLOCATOR_VERB_REALLOC: {
+			void* data = grd_realloc_crash_on_failure(params.old_data, params.old_size, params.new_size, params.alignment);
+			return { .data = data, .usable_size = grd_crt_usable_size(data, params.alignment) };
+		}
 		case GRD_ALLOCATOR_VERB_FREE:
-			free(params.old_data);
+			grd_crt_free(params.old_data);
 			break;
 		case GRD_ALLOCATOR_VERB_GET_TYPE:
 			return { .allocator_type = grd_reflect_type_of<GrdCrtAllocator>() };
@@ -120,6 +187,22 @@ GRD_DEDUP void* GrdMalloc(GrdAllocator allocator, u64 size, GrdCodeLoc loc = grd
 	return allocator.proc(allocator.data, p).data;
 }
 
+// |out_usable_size| gets how many bytes may be used, at least |size|.
+GRD_DEDUP void* GrdMallocAligned(GrdAllocator allocator, u64 size, u64 alignment, u64* out_usable_size = NULL, GrdCodeLoc loc = grd_caller_loc()) {
+	assert(grd_is_power_of_two(alignment));
+	GrdAllocatorProcParams p = {
+		.verb = GRD_ALLOCATOR_VERB_ALLOC,
+		.new_size = size,
+		.alignment = alignment,
+		.loc = loc
+	};
+	auto result = allocator.proc(allocator.data, p);
+	if (out_usable_size) {
+		*out_usable_size = grd_max_u64(result.usable_size, size);
+	}
+	return result.data;
+}
+
 GRD_DEDUP void* GrdMalloc(u64 size, GrdCodeLoc loc = grd_caller_loc()) {
 	return GrdMalloc(c_allocator, size, loc);
 }
@@ -151,13 +234,31 @@ GRD_DEDUP void* GrdRealloc(GrdAllocator allocator, void* data, u64 old_size, u64
 	return allocator.proc(allocator.data, p).data;
 }
 
+// |alignment| must be the one |data| was allocated with.
+GRD_DEDUP void* GrdReallocAligned(GrdAllocator allocator, void* data, u64 old_size, u64 new_size, u64 alignment, u64* out_usable_size = NULL, GrdCodeLoc loc = grd_caller_loc()) {
+	assert(grd_is_power_of_two(alignment));
+	GrdAllocatorProcParams p = {
+		.verb = GRD_ALLOCATOR_VERB_REALLOC,
+		.old_data = data,
+		.old_size = old_size,
+		.new_size = new_size,
+		.alignment = alignment,
+		.loc = loc
+	};
+	auto result = allocator.proc(allocator.data, p);
+	if (out_usable_size) {
+		*out_usable_size = grd_max_u64(result.usable_size, new_size);
+	}
+	return result.data;
+}
+
 GRD_DEDUP void* GrdRealloc(void* data, u64 old_size, u64 new_size, GrdCodeLoc loc = grd_caller_loc()) {
 	return GrdRealloc(c_allocator, data, old_size, new_size, loc);
 }
 
 template <typename T>
 GRD_DEDUP T* GrdAlloc(GrdAllocator allocator, u64 count, GrdCodeLoc loc = grd_caller_loc()) {
-	return (T*) GrdMalloc(allocator, sizeof(T) * count, loc);
+	return (T*) GrdMallocAligned(allocator, sizeof(T) * count, alignof(T), NULL, loc);
 }
 
 template <typename T>
@@ -2,6 +2,7 @@
 
 #include "grd_allocator.h"
 #include "grd_panic.h"
+#include "grd_virtual_memory.h"
 
 constexpr u64 GRD_DEFAULT_ARENA_SIZE = 16 * 1024;
 
@@ -13,6 +14,9 @@ struct GrdArena {
 struct GrdLinkedArenas {
 	GrdAllocator parent_allocator;
 	u64          arena_size = 0;
+	// Allocation starts looking from here, arenas before it are full.
+	GrdArena*    current = NULL;
+	s64          current_index = 0;
 	GrdArena     first;
 };
 
@@ -39,14 +43,22 @@ GRD_DEDUP GrdArena* grd_make_arena(GrdAllocator parent_allocator, u64 size) {
 	return arena;
 }
 
+GRD_DEDUP u8* grd_arena_data(GrdArena* arena) {
+	return (u8*) (arena + 1);
+}
+
 GRD_DEDUP GrdAllocatorProcResult grd_arena_allocator_proc(void* allocator_data, GrdAllocatorProcParams p) {
 	auto arenas = (GrdLinkedArenas*) allocator_data;
 	switch (p.verb) {
 		case GRD_ALLOCATOR_VERB_ALLOC: {
-			GrdArena* last = &arenas->first;
+			// Allocations are packed unless asked for an alignment.
+			u64       alignment = grd_max_u64(p.alignment, 1);
+			GrdArena* last = arenas->current;
 			GrdArena* found = NULL;
+			u64       start = 0;
 			while (true) {
-				if (last->allocated + p.new_size <= arenas->arena_size) { 
+				start = grd_align((u64) grd_arena_data(last) + last->allocated, alignment) - (u64) grd_arena_data(last);
+				if (start + p.new_size <= arenas->arena_size) { 
 					found = last;
 					break;
 				}
@@ -57,18 +69,31 @@ GRD_DEDUP GrdAllocatorProcResult grd_arena_allocator_proc(void* allocator_data,
 					break;
 				}
 				last = last->next;
+				arenas->current_index += 1;
 			}
 			if (!found) {
-				u64 new_arena_size = grd_max_u64(arenas->arena_size, p.new_size);
-				last = grd_make_arena(arenas->parent_allocator, new_arena_size);
+				u64 new_arena_size = grd_max_u64(arenas->arena_size, p.new_size + alignment - 1);
+				last->next = grd_make_arena(arenas->parent_allocator, new_arena_size);
+				last = last->next;
+				arenas->current_index += 1;
+				start = grd_align((u64) grd_arena_data(last), alignment) - (u64) grd_arena_data(last);
 			}
-			void* ptr = grd_ptr_add(last, sizeof(GrdArena) + last->allocated);
-			last->allocated += p.new_size;
-			return { .data = ptr };
+			arenas->current = last;
+			last->allocated = start + p.new_size;
+			return { .data = grd_arena_data(last) + start };
 		}
 		break;
 		case GRD_ALLOCATOR_VERB_REALLOC: {
-			auto res = grd_arena_allocator_proc(allocator_data, { .verb = GRD_ALLOCATOR_VERB_ALLOC, .new_size = p.new_size, .loc = p.loc });
+			// Last allocation in the current arena grows in place.
+			GrdArena* last = arenas->current;
+			if (p.old_data && last->allocated >= p.old_size) {
+				u64 start = last->allocated - p.old_size;
+				if (p.old_data == grd_arena_data(last) + start && start + p.new_size <= arenas->arena_size) {
+					last->allocated = start + p.new_size;
+					return { .data = p.old_data };
+				}
+			}
+			auto res = grd_arena_allocator_proc(allocator_data, { .verb = GRD_ALLOCATOR_VERB_ALLOC, .new_size = p.new_size, .alignment = p.alignment, .loc = p.loc });
 			memcpy(res.data, p.old_data, grd_min_u64(p.old_size, p.new_size));
 			grd_arena_allocator_proc(allocator_data, { .verb = GRD_ALLOCATOR_VERB_FREE, .old_data = p.old_data, .loc = p.loc });
 			return res;
@@ -94,6 +119,7 @@ GRD_DEDUP GrdAllocator grd_make_arena_allocator(GrdAllocator parent_allocator, u
 		.parent_allocator = parent_allocator,
 		.arena_size = arena_size,
 	};
+	arenas->current = &arenas->first;
 	GrdAllocator allocator = {
 		.proc = grd_arena_allocator_proc,
 		.data = arenas,
@@ -111,33 +137,22 @@ struct ArenaAllocatorSnapshot {
 };
 
 GRD_DEDUP ArenaAllocatorSnapshot grd_snapshot(GrdLinkedArenas* allocator) {
-	s64 current_arena_index = 0;
-	u64 current_arena_allocated = 0;
-
-	auto arena = &allocator->first;
-	while (arena) {
-		current_arena_allocated = arena->allocated;
-		if (arena->allocated < allocator->arena_size) {
-			break;
-		}
-		current_arena_index += 1;
-		arena = arena->next;
-	}
-
 	return {
-		.current_arena_index = current_arena_index,
-		.current_arena_allocated = current_arena_allocated,
+		.current_arena_index = allocator->current_index,
+		.current_arena_allocated = allocator->current->allocated,
 	};
 }
 
 GRD_DEDUP void grd_restore(GrdLinkedArenas* allocator, ArenaAllocatorSnapshot snapshot) {
 	auto arena = &allocator->first;
-	s32 i = 0;
+	s64 i = 0;
 	while (arena) {
 		if (i < snapshot.current_arena_index) {
 			arena->allocated = allocator->arena_size;
-		} if (i == snapshot.current_arena_index) {
+		} else if (i == snapshot.current_arena_index) {
 			arena->allocated = snapshot.current_arena_allocated;
+			allocator->current = arena;
+			allocator->current_index = i;
 		} else {
 			arena->allocated = 0;
 		}
@@ -146,18 +161,193 @@ GRD_DEDUP void grd_restore(GrdLinkedArenas* allocator, ArenaAllocatorSnapshot sn
 	}
 }
 
+GRD_DEDUP constexpr u64 GRD_DEFAULT_VIRTUAL_ARENA_RESERVE = 64ull * 1024 * 1024 * 1024;
+// Pages are committed this many bytes at a time.
+GRD_DEDUP constexpr u64 GRD_VIRTUAL_ARENA_COMMIT_STEP     = 64 * 1024;
+GRD_DEDUP constexpr u64 GRD_VIRTUAL_ARENA_ALIGNMENT       = 16;
+
+// Arena in one reserved address range, pages are committed as it grows.
+// Allocation is a pointer bump, snapshot and restore are O(1).
+// The struct itself is at the start of the range.
+struct GrdVirtualArena {
+	u64  reserved = 0;
+	u64  committed = 0;
+	// Offset of the end of the last allocation from the start of the range.
+	u64  allocated = 0;
+	// grd_restore() gives pages above the restored offset back to the OS.
+	bool decommit_on_restore = false;
+
+	GRD_REFLECT(GrdVirtualArena) {}
+};
+
+GRD_DEDUP u8* grd_virtual_arena_base(GrdVirtualArena* arena) {
+	return (u8*) arena;
+}
+
+GRD_DEDUP void grd_virtual_arena_set_end(GrdVirtualArena* arena, u64 end) {
+	if (end > arena->committed) {
+		if (end > arena->reserved) {
+			grd_panic("GrdVirtualArena is out of reserved memory");
+		}
+		u64 new_committed = grd_min_u64(grd_align(end, GRD_VIRTUAL_ARENA_COMMIT_STEP), arena->reserved);
+		if (!grd_os_commit(grd_virtual_arena_base(arena) + arena->committed, new_committed - arena->committed)) {
+			grd_panic("Failed to commit memory of GrdVirtualArena");
+		}
+		arena->committed = new_committed;
+	}
+	arena->allocated = end;
+}
+
+// |alignment| of 0 is GRD_VIRTUAL_ARENA_ALIGNMENT.
+GRD_DEDUP void* grd_virtual_arena_alloc(GrdVirtualArena* arena, u64 size, u64 alignment = 0) {
+	if (alignment == 0) {
+		alignment = GRD_VIRTUAL_ARENA_ALIGNMENT;
+	}
+	// Base of the range is page aligned, offsets align as addresses do.
+	if (alignment > grd_os_page_size()) {
+		grd_panic("GrdVirtualArena alignment of % is larger than page size", alignment);
+	}
+	u64 start = grd_align(arena->allocated, alignment);
+	grd_virtual_arena_set_end(arena, start + size);
+	return grd_virtual_arena_base(arena) + start;
+}
+
+GRD_DEDUP GrdAllocatorProcResult grd_virtual_arena_allocator_proc(void* allocator_data, GrdAllocatorProcParams p) {
+	auto arena = (GrdVirtualArena*) allocator_data;
+	switch (p.verb) {
+		case GRD_ALLOCATOR_VERB_ALLOC:
+			return { .data = grd_virtual_arena_alloc(arena, p.new_size, p.alignment) };
+		case GRD_ALLOCATOR_VERB_REALLOC: {
+			// Last allocation grows in place.
+			if (p.old_data && p.old_size <= arena->allocated && p.old_data == grd_virtual_arena_base(arena) + arena->allocated - p.old_size) {
+				grd_virtual_arena_set_end(arena, arena->allocated - p.old_size + p.new_size);
+				return { .data = p.old_data };
+			}
+			void* data = grd_virtual_arena_alloc(arena, p.new_size, p.alignment);
+			if (p.old_data) {
+				memcpy(data, p.old_data, grd_min_u64(p.old_size, p.new_size));
+			}
+			return { .data = data };
+		}
+		case GRD_ALLOCATOR_VERB_FREE:
+			return {};
+		case GRD_ALLOCATOR_VERB_GET_TYPE:
+			return { .allocator_type = grd_reflect_type_of<GrdVirtualArena>() };
+		case GRD_ALLOCATOR_VERB_FREE_ALLOCATOR:
+			grd_os_unmap(arena, arena->reserved);
+			break;
+	}
+	return {};
+}
+
+// Only address space is reserved, so |reserve_size| may be much larger than needed.
+GRD_DEDUP GrdAllocator grd_make_virtual_arena_allocator(u64 reserve_size = GRD_DEFAULT_VIRTUAL_ARENA_RESERVE, bool decommit_on_restore = false) {
+	reserve_size = grd_align(grd_max_u64(reserve_size, GRD_VIRTUAL_ARENA_COMMIT_STEP), GRD_VIRTUAL_ARENA_COMMIT_STEP);
+	void* base = grd_os_reserve(reserve_size);
+	if (!base || !grd_os_commit(base, GRD_VIRTUAL_ARENA_COMMIT_STEP)) {
+		grd_panic("Failed to reserve memory for GrdVirtualArena");
+	}
+	auto arena = new(base) GrdVirtualArena();
+	arena->reserved = reserve_size;
+	arena->committed = GRD_VIRTUAL_ARENA_COMMIT_STEP;
+	arena->allocated = sizeof(GrdVirtualArena);
+	arena->decommit_on_restore = decommit_on_restore;
+	return {
+		.proc = grd_virtual_arena_allocator_proc,
+		.data = arena,
+	};
+}
+
+GRD_DEDUP ArenaAllocatorSnapshot grd_snapshot(GrdVirtualArena* arena) {
+	return { .current_arena_allocated = arena->allocated };
+}
+
+GRD_DEDUP void grd_restore(GrdVirtualArena* arena, ArenaAllocatorSnapshot snapshot) {
+	assert(snapshot.current_arena_allocated <= arena->allocated);
+	arena->allocated = snapshot.current_arena_allocated;
+	if (arena->decommit_on_restore) {
+		// Keep the page the arena continues in.
+		u64 keep = grd_align(arena->allocated, GRD_VIRTUAL_ARENA_COMMIT_STEP);
+		if (arena->committed > keep) {
+			grd_os_decommit(grd_virtual_arena_base(arena) + keep, arena->committed - keep);
+			arena->committed = keep;
+		}
+	}
+}
+
 GRD_DEDUP ArenaAllocatorSnapshot grd_snapshot(GrdAllocator allocator) {
 	auto type = grd_get_allocator_type(allocator);
-	if (type != grd_reflect_type_of<GrdLinkedArenas>()) {
-		return {};
+	if (type == grd_reflect_type_of<GrdLinkedArenas>()) {
+		return grd_snapshot((GrdLinkedArenas*) allocator.data);
+	}
+	if (type == grd_reflect_type_of<GrdVirtualArena>()) {
+		return grd_snapshot((GrdVirtualArena*) allocator.data);
 	}
-	return grd_snapshot((GrdLinkedArenas*) allocator.data);
+	return {};
 }
 
 GRD_DEDUP void grd_restore(GrdAllocator allocator, ArenaAllocatorSnapshot snapshot) {
 	auto type = grd_get_allocator_type(allocator);
-	if (type != grd_reflect_type_of<GrdLinkedArenas>()) {
-		return;
+	if (type == grd_reflect_type_of<GrdLinkedArenas>()) {
+		grd_restore((GrdLinkedArenas*) allocator.data, snapshot);
+	} else if (type == grd_reflect_type_of<GrdVirtualArena>()) {
+		grd_restore((GrdVirtualArena*) allocator.data, snapshot);
 	}
-	grd_restore((GrdLinkedArenas*) allocator.data, snapshot);
 }
+
+// Per-thread arenas for temporary allocations, see GrdScratchScope.
+// Memory stays committed up to the highest use until the thread exits.
+GRD_DEDUP constexpr s32 GRD_SCRATCH_ARENAS_COUNT  = 2;
+GRD_DEDUP constexpr u64 GRD_SCRATCH_ARENA_RESERVE = 8ull * 1024 * 1024 * 1024;
+
+struct GrdScratchArenas {
+	GrdAllocator arenas[GRD_SCRATCH_ARENAS_COUNT] = {};
+
+	~GrdScratchArenas() {
+		for (auto& it: arenas) {
+			if (it.data) {
+				grd_free_allocator(it);
+			}
+		}
+	}
+};
+
+GRD_DEDUP thread_local GrdScratchArenas grd_scratch_arenas;
+
+// Returns a scratch arena of the thread that isn't |conflict|.
+// A function that allocates its result in an arena it was given passes that arena
+//   as |conflict|, so its temporaries don't go in between the results
+//   when the caller's arena is a scratch arena too.
+GRD_DEDUP GrdAllocator grd_get_scratch(GrdAllocator conflict = {}) {
+	for (auto& it: grd_scratch_arenas.arenas) {
+		if (!it.data) {
+			it = grd_make_virtual_arena_allocator(GRD_SCRATCH_ARENA_RESERVE);
+		}
+		if (it.data != conflict.data) {
+			return it;
+		}
+	}
+	grd_panic("Every scratch arena conflicts");
+	return {};
+}
+
+// Scratch arena of the thread, everything allocated from |allocator|
+//   in the scope is released at its end:
+//   GrdScratchScope scratch;
+//   GrdArray<s64> tmp = { .allocator = scratch.allocator };
+struct GrdScratchScope {
+	GrdAllocator           allocator;
+	ArenaAllocatorSnapshot snapshot;
+
+	GrdScratchScope(GrdAllocator conflict = {}) {
+		allocator = grd_get_scratch(conflict);
+		snapshot = grd_snapshot((GrdVirtualArena*) allocator.data);
+	}
+
+	~GrdScratchScope() {
+		grd_restore((GrdVirtualArena*) allocator.data, snapshot);
+	}
+
+	GrdScratchScope(const GrdScratchScope&) = delete;
+	GrdScratchScope& operator=(const GrdScratchScope&) = delete;
+};
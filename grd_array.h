@@ -54,14 +54,18 @@ GRD_DEDUP T* grd_reserve(GrdArray<T>* arr, s64 length, s64 index = -1, GrdCodeLo
 		if (arr->capacity <= 0) {
 			arr->capacity = 8;
 		}
-		arr->data = GrdAlloc<T>(arr->allocator, arr->capacity, loc);
+		u64 usable_size;
+		arr->data     = (T*) GrdMallocAligned(arr->allocator, arr->capacity * sizeof(T), alignof(T), &usable_size, loc);
+		// Slack the allocator handed out anyway becomes capacity.
+		arr->capacity = usable_size / sizeof(T);
 	}
 
 	if (target_capacity > arr->capacity) {
 		s64 old_capacity = arr->capacity;
 		assert(old_capacity > 0);
-		arr->capacity = grd_max(old_capacity * 2, target_capacity);
-		arr->data     = (T*) GrdRealloc(arr->allocator, arr->data, old_capacity * sizeof(T), arr->capacity * sizeof(T), loc);
+		u64 usable_size;
+		arr->data     = (T*) GrdReallocAligned(arr->allocator, arr->data, old_capacity * sizeof(T), grd_max(old_capacity * 2, target_capacity) * sizeof(T), alignof(T), &usable_size, loc);
+		arr->capacity = usable_size / sizeof(T);
 	}
 
 	memmove(arr->data + index + length, arr->data + index, (grd_len(*arr) - index) * sizeof(T));
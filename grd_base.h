@@ -39,10 +39,19 @@
 // Allows us to pass an argument with commas(,) to a macro without confusing a compiler. 
 #define GRD_SINGLE_ARG(...) __VA_ARGS__
 
-#if defined(__clang__)
+#if defined(__clang__) || defined(__GNUC__)
 	#define GRD_FORCE_INLINE __attribute__((always_inline))
+	#define GRD_NO_INLINE    __attribute__((noinline))
 #elif defined(_MSC_VER)
 	#define GRD_FORCE_INLINE __forceinline
+	#define GRD_NO_INLINE    __declspec(noinline)
+#endif
+
+// Lets an empty member take no space.
+#if GRD_COMPILER_MSVC
+	#define GRD_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+	#define GRD_NO_UNIQUE_ADDRESS [[no_unique_address]]
 #endif
 
 #if GRD_COMPILER_MSVC
@@ -51,6 +60,18 @@
 	#define GrdDebugBreak() __builtin_debugtrap()
 #endif
 
+// Hints the CPU to start loading the cache line of |ptr| for reading.
+#if GRD_COMPILER_MSVC
+	#include <intrin.h>
+	#if GRD_ARCH_X64
+		#define GrdPrefetch(ptr) _mm_prefetch((const char*) (ptr), _MM_HINT_T0)
+	#else
+		#define GrdPrefetch(ptr) __prefetch(ptr)
+	#endif
+#else
+	#define GrdPrefetch(ptr) __builtin_prefetch(ptr)
+#endif
+
 #define GRD_DEDUP inline
 #define GRD_DEF inline auto 
 
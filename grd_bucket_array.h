@@ -0,0 +1,85 @@
+#pragma once
+
+#include "grd_array.h"
+
+// Array of fixed size buckets, items never move once added,
+//   so pointers to them stay valid while the array grows.
+// Item |i| is in bucket i >> BUCKET_SHIFT at i & BUCKET_MASK.
+// Only the list of buckets is reallocated, buckets are kept until free().
+template <typename T, s64 BUCKET_SIZE = 64>
+struct GrdBucketArray {
+	static_assert(grd_is_power_of_two(BUCKET_SIZE));
+
+	static constexpr s64 BUCKET_SHIFT = [] {
+		s64 shift = 0;
+		while ((s64(1) << shift) < BUCKET_SIZE) {
+			shift += 1;
+		}
+		return shift;
+	}();
+	static constexpr s64 BUCKET_MASK = BUCKET_SIZE - 1;
+
+	GrdArray<T*>    buckets;
+	s64             count     = 0;
+	GrdAllocator    allocator = c_allocator;
+
+	T& operator[](s64 index) {
+		if (index < 0) {
+			index += count;
+		}
+		assert(index >= 0);
+		assert(index < count);
+		return buckets.data[index >> BUCKET_SHIFT][index & BUCKET_MASK];
+	}
+
+	struct Iterator {
+		GrdBucketArray* arr;
+		s64             index;
+
+		T& operator*() { return (*arr)[index]; }
+		Iterator& operator++() { index += 1; return *this; }
+		bool operator!=(const Iterator& rhs) { return index != rhs.index; }
+	};
+
+	Iterator begin() { return { this, 0 }; }
+	Iterator end() { return { this, count }; }
+
+	void free(GrdCodeLoc loc = grd_caller_loc()) {
+		for (auto bucket: buckets) {
+			GrdFree(allocator, bucket, loc);
+		}
+		buckets.free(loc);
+		count = 0;
+	}
+};
+
+template <typename T, s64 BUCKET_SIZE>
+GRD_DEDUP s64 grd_len(const GrdBucketArray<T, BUCKET_SIZE>& arr) {
+	return arr.count;
+}
+
+// Returns uninitialized slot at the end.
+template <typename T, s64 BUCKET_SIZE>
+GRD_DEDUP T* grd_reserve(GrdBucketArray<T, BUCKET_SIZE>* arr, GrdCodeLoc loc = grd_caller_loc()) {
+	using Arr = GrdBucketArray<T, BUCKET_SIZE>;
+	s64 bucket_idx = arr->count >> Arr::BUCKET_SHIFT;
+	// Buckets stay allocated after grd_clear().
+	if (bucket_idx == grd_len(arr->buckets)) {
+		arr->buckets.allocator = arr->allocator;
+		grd_add(&arr->buckets, GrdAlloc<T>(arr->allocator, BUCKET_SIZE, loc), -1, loc);
+	}
+	T* ptr = arr->buckets.data[bucket_idx] + (arr->count & Arr::BUCKET_MASK);
+	arr->count += 1;
+	return ptr;
+}
+
+template <typename T, s64 BUCKET_SIZE>
+GRD_DEDUP T* grd_add(GrdBucketArray<T, BUCKET_SIZE>* arr, std::type_identity_t<T> item, GrdCodeLoc loc = grd_caller_loc()) {
+	T* ptr = grd_reserve(arr, loc);
+	return new(ptr) T(item);
+}
+
+template <typename T, s64 BUCKET_SIZE>
+GRD_DEDUP void grd_clear(GrdBucketArray<T, BUCKET_SIZE>* arr, GrdCodeLoc loc = grd_caller_loc()) {
+	arr->count = 0;
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "grd_hash_map.h"
+#include "grd_scoped.h"
+#include "sync/grd_mutex.h"
+
+// Hash map that can be used from multiple threads at once.
+// Keys are spread over GRD_CONCURRENT_HASH_MAP_SHARDS_COUNT independent
+//   GrdHashMap's by the top bits of their hash, every shard has its own lock,
+//   so threads only contend when they touch the same shard.
+//
+// Values are copied in and out, pointers into the map are never handed out,
+//   because they would be invalidated by a concurrent put into the same shard.
+// Use grd_update/grd_upsert to modify a value in place under the shard lock.
+
+GRD_DEDUP constexpr s64 GRD_CONCURRENT_HASH_MAP_SHARDS_COUNT_LOG2 = 6;
+GRD_DEDUP constexpr s64 GRD_CONCURRENT_HASH_MAP_SHARDS_COUNT      = 1 << GRD_CONCURRENT_HASH_MAP_SHARDS_COUNT_LOG2;
+
+// Each shard is on its own cache lines, so locking one doesn't
+//   invalidate the line of its neighbour.
+template <typename K, typename V, GrdHashMapLayout L>
+struct alignas(64) GrdConcurrentHashMapShard {
+	GrdMutex            mutex;
+	GrdHashMap<K, V, L> map;
+};
+
+template <typename K, typename V, GrdHashMapLayout L = GRD_HASH_MAP_LAYOUT_ENTRIES>
+struct GrdConcurrentHashMap {
+	GrdConcurrentHashMapShard<K, V, L>* shards = NULL;
+	GrdAllocator                        allocator = c_allocator;
+	GrdCodeLoc                          loc = grd_caller_loc();
+
+	void free() {
+		if (shards) {
+			for (auto i: grd_range(GRD_CONCURRENT_HASH_MAP_SHARDS_COUNT)) {
+				shards[i].map.free();
+				shards[i].mutex.free();
+			}
+			GrdFree(allocator, shards, loc);
+		}
+		*this = {};
+	}
+};
+
+// Unlike GrdHashMap, can't be lazily initialized, because
+//   the first put may happen on many threads at once.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_make_concurrent_hash_map(GrdConcurrentHashMap<K, V, L>* out_map, GrdAllocator allocator = c_allocator, GrdCodeLoc loc = grd_caller_loc()) {
+	*out_map = {
+		.allocator = allocator,
+		.loc = loc,
+	};
+	out_map->shards = GrdAlloc<GrdConcurrentHashMapShard<K, V, L>>(allocator, GRD_CONCURRENT_HASH_MAP_SHARDS_COUNT, loc);
+	for (auto i: grd_range(GRD_CONCURRENT_HASH_MAP_SHARDS_COUNT)) {
+		auto shard = new(&out_map->shards[i]) GrdConcurrentHashMapShard<K, V, L>();
+		shard->map.allocator = allocator;
+		shard->map.loc = loc;
+		grd_make_mutex(&shard->mutex);
+	}
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP GrdConcurrentHashMapShard<K, V, L>* grd_concurrent_hash_map_shard(GrdConcurrentHashMap<K, V, L>* map, GrdHash64 hash) {
+	assert(map->shards);
+	// Shards use the top bits. Inner maps mix every bit of the hash into the slot,
+	//   so keys of one shard still spread over all of its slots.
+	return &map->shards[hash >> (64 - GRD_CONCURRENT_HASH_MAP_SHARDS_COUNT_LOG2)];
+}
+
+// Returns true if |key| wasn't in the map.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP bool grd_put(GrdConcurrentHashMap<K, V, L>* map, std::type_identity_t<K> key, std::type_identity_t<V> value) {
+	GrdHash64 hash = grd_hash_key(key);
+	auto shard = grd_concurrent_hash_map_shard(map, hash);
+	GrdScopedLock(shard->mutex);
+	s64 count_before = shard->map.count;
+	s64 idx = grd_hash_map_put_slot(&shard->map, key, hash);
+	grd_hash_map_slot_value(&shard->map, idx) = value;
+	return shard->map.count != count_before;
+}
+
+// Copies value of |key| to |out_value| if it is in the map.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP bool grd_get(GrdConcurrentHashMap<K, V, L>* map, std::type_identity_t<K> key, V* out_value) {
+	GrdHash64 hash = grd_hash_key(key);
+	auto shard = grd_concurrent_hash_map_shard(map, hash);
+	GrdScopedLock(shard->mutex);
+	V* value = grd_hash_map_get_value(&shard->map, key, hash);
+	if (!value) {
+		return false;
+	}
+	if (out_value) {
+		*out_value = *value;
+	}
+	return true;
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP bool grd_contains(GrdConcurrentHashMap<K, V, L>* map, std::type_identity_t<K> key) {
+	return grd_get(map, key, (V*) NULL);
+}
+
+// Copies removed value to |out_value| if it's not NULL.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP bool grd_remove(GrdConcurrentHashMap<K, V, L>* map, std::type_identity_t<K> key, V* out_value = NULL) {
+	GrdHash64 hash = grd_hash_key(key);
+	auto shard = grd_concurrent_hash_map_shard(map, hash);
+	GrdScopedLock(shard->mutex);
+	return grd_hash_map_remove_key(&shard->map, key, hash, out_value);
+}
+
+// Returns the value that is in the map after the call:
+//   existing one if |key| was already there, |value| otherwise.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP V grd_get_or_insert(GrdConcurrentHashMap<K, V, L>* map, std::type_identity_t<K> key, std::type_identity_t<V> value) {
+	GrdHash64 hash = grd_hash_key(key);
+	auto shard = grd_concurrent_hash_map_shard(map, hash);
+	GrdScopedLock(shard->mutex);
+	V* existing = grd_hash_map_get_value(&shard->map, key, hash);
+	if (existing) {
+		return *existing;
+	}
+	s64 idx = grd_hash_map_put_slot(&shard->map, key, hash);
+	grd_hash_map_slot_value(&shard->map, idx) = value;
+	return value;
+}
+
+// Calls |proc(V* value)| under the shard lock if |key| is in the map.
+// |proc| must not access |map|.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP bool grd_update(GrdConcurrentHashMap<K, V, L>* map, std::type_identity_t<K> key, auto&& proc) {
+	GrdHash64 hash = grd_hash_key(key);
+	auto shard = grd_concurrent_hash_map_shard(map, hash);
+	GrdScopedLock(shard->mutex);
+	V* value = grd_hash_map_get_value(&shard->map, key, hash);
+	if (!value) {
+		return false;
+	}
+	proc(value);
+	return true;
+}
+
+// Calls |proc(V* value, bool inserted)| under the shard lock.
+// If |key| wasn't in the map, it's inserted with value-initialized V first.
+// |proc| must not access |map|.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_upsert(GrdConcurrentHashMap<K, V, L>* map, std::type_identity_t<K> key, auto&& proc) {
+	GrdHash64 hash = grd_hash_key(key);
+	auto shard = grd_concurrent_hash_map_shard(map, hash);
+	GrdScopedLock(shard->mutex);
+	V* value = grd_hash_map_get_value(&shard->map, key, hash);
+	bool inserted = value == NULL;
+	if (inserted) {
+		value = &grd_hash_map_slot_value(&shard->map, grd_hash_map_put_slot(&shard->map, key, hash));
+		*value = V{};
+	}
+	proc(value, inserted);
+}
+
+// Shards are locked one at a time, so it's only a snapshot
+//   if other threads modify the map.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_len(GrdConcurrentHashMap<K, V, L>* map) {
+	s64 total = 0;
+	for (auto i: grd_range(GRD_CONCURRENT_HASH_MAP_SHARDS_COUNT)) {
+		auto shard = &map->shards[i];
+		GrdScopedLock(shard->mutex);
+		total += shard->map.count;
+	}
+	return total;
+}
+
+// Calls |proc(K* key, V* value)| for every entry, holding the lock of its shard.
+// |proc| must not access |map|.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_for_each(GrdConcurrentHashMap<K, V, L>* map, auto&& proc) {
+	for (auto i: grd_range(GRD_CONCURRENT_HASH_MAP_SHARDS_COUNT)) {
+		auto shard = &map->shards[i];
+		GrdScopedLock(shard->mutex);
+		for (auto j: grd_range(shard->map.capacity)) {
+			if (grd_hash_map_slot_is_occupied(&shard->map, j)) {
+				proc(&grd_hash_map_slot_key(&shard->map, j), &grd_hash_map_slot_value(&shard->map, j));
+			}
+		}
+		auto old = grd_hash_map_old_table(&shard->map);
+		for (auto j: grd_range(old.capacity)) {
+			if (grd_hash_map_slot_is_occupied(&old, j)) {
+				proc(&grd_hash_map_slot_key(&old, j), &grd_hash_map_slot_value(&old, j));
+			}
+		}
+	}
+}
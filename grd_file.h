@@ -6,6 +6,8 @@
 #if GRD_IS_POSIX
 	#include <fcntl.h>
 	#include <dirent.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
 #endif
 
 using GrdOpenFileFlag = u32;
@@ -149,6 +151,95 @@ GRD_DEDUP void grd_fsync(GrdFile* file) {
 }
 #endif
 
+// Read-only view of a whole file.
+struct GrdMappedFile {
+	void* data = NULL;
+	s64   size = 0;
+#if GRD_OS_WINDOWS
+	GRD_WIN_HANDLE mapping = NULL;
+#endif
+};
+
+#if GRD_OS_WINDOWS
+GRD_DEDUP GrdTuple<s64, GrdError*> grd_get_file_size(GrdFile* file) {
+	GRD_WIN_LARGE_INTEGER size;
+	if (!GetFileSizeEx(file->handle, &size)) {
+		return { -1, grd_windows_error() };
+	}
+	return { size.QuadPart, NULL };
+}
+
+// Pages are shared with other processes mapping the same file through the page cache.
+// |file| can be closed once it's mapped.
+GRD_DEDUP GrdTuple<GrdMappedFile, GrdError*> grd_map_file(GrdFile* file) {
+	auto [size, e] = grd_get_file_size(file);
+	if (e) {
+		return { {}, e };
+	}
+	GrdMappedFile result;
+	result.size = size;
+	if (size == 0) {
+		return { result, NULL };
+	}
+	result.mapping = CreateFileMappingW(file->handle, NULL, GRD_WIN_PAGE_READONLY, 0, 0, NULL);
+	if (!result.mapping) {
+		return { {}, grd_windows_error() };
+	}
+	result.data = MapViewOfFile(result.mapping, GRD_WIN_FILE_MAP_READ, 0, 0, 0);
+	if (!result.data) {
+		auto e = grd_windows_error();
+		CloseHandle(result.mapping);
+		return { {}, e };
+	}
+	return { result, NULL };
+}
+
+GRD_DEDUP void grd_unmap_file(GrdMappedFile* mapped) {
+	if (mapped->data) {
+		UnmapViewOfFile(mapped->data);
+	}
+	if (mapped->mapping) {
+		CloseHandle(mapped->mapping);
+	}
+	*mapped = {};
+}
+#elif GRD_IS_POSIX
+GRD_DEDUP GrdTuple<s64, GrdError*> grd_get_file_size(GrdFile* file) {
+	struct stat st;
+	if (fstat(file->handle, &st) == -1) {
+		return { -1, grd_posix_error() };
+	}
+	return { st.st_size, NULL };
+}
+
+// Pages are shared with other processes mapping the same file through the page cache.
+// |file| can be closed once it's mapped.
+GRD_DEDUP GrdTuple<GrdMappedFile, GrdError*> grd_map_file(GrdFile* file) {
+	auto [size, e] = grd_get_file_size(file);
+	if (e) {
+		return { {}, e };
+	}
+	GrdMappedFile result;
+	result.size = size;
+	if (size == 0) {
+		return { result, NULL };
+	}
+	void* data = mmap(NULL, (u64) size, PROT_READ, MAP_SHARED, file->handle, 0);
+	if (data == MAP_FAILED) {
+		return { {}, grd_posix_error() };
+	}
+	result.data = data;
+	return { result, NULL };
+}
+
+GRD_DEDUP void grd_unmap_file(GrdMappedFile* mapped) {
+	if (mapped->data) {
+		munmap(mapped->data, (u64) mapped->size);
+	}
+	*mapped = {};
+}
+#endif
+
 GRD_DEDUP GrdError* grd_write_file(GrdFile* file, void* data, s64 size) {
 	s64 total_written = 0;
 	while (total_written < size) {
@@ -0,0 +1,376 @@
+#pragma once
+
+#include "grd_hash_map.h"
+#include "grd_data_ops.h"
+
+#if GRD_ARCH_X64
+	#include <emmintrin.h>
+#elif GRD_ARCH_ARM64
+	#include <arm_neon.h>
+#endif
+
+// Swiss table style open addressing map.
+// Each slot has a 1-byte control tag stored in a separate array,
+//   tags of 16 consecutive slots are compared at once with SIMD,
+//   so most lookups touch one control group and one slot.
+// Control tag is either one of GRD_FLAT_HASH_MAP_CTRL_* values
+//   or lower 7 bits of the key hash (slot is full).
+
+using GrdFlatHashMapCtrl = s8;
+
+GRD_DEDUP constexpr GrdFlatHashMapCtrl GRD_FLAT_HASH_MAP_CTRL_EMPTY   = -128;
+GRD_DEDUP constexpr GrdFlatHashMapCtrl GRD_FLAT_HASH_MAP_CTRL_DELETED = -2;
+GRD_DEDUP constexpr s64                GRD_FLAT_HASH_MAP_GROUP_WIDTH  = 16;
+
+// Bit i is set if control byte i of the group matched.
+using GrdFlatHashMapMask = u32;
+
+#if GRD_ARCH_ARM64
+GRD_DEDUP GrdFlatHashMapMask grd_flat_hash_map_neon_movemask(uint8x16_t cmp) {
+	static const u8 bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint8x16_t masked = vandq_u8(cmp, vld1q_u8(bits));
+	u32 lo = vaddv_u8(vget_low_u8(masked));
+	u32 hi = vaddv_u8(vget_high_u8(masked));
+	return lo | (hi << 8);
+}
+#endif
+
+GRD_DEDUP GrdFlatHashMapMask grd_flat_hash_map_match(GrdFlatHashMapCtrl* group, GrdFlatHashMapCtrl tag) {
+#if GRD_ARCH_X64
+	__m128i ctrl = _mm_loadu_si128((__m128i*) group);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl));
+#elif GRD_ARCH_ARM64
+	int8x16_t ctrl = vld1q_s8(group);
+	return grd_flat_hash_map_neon_movemask(vceqq_s8(ctrl, vdupq_n_s8(tag)));
+#else
+	GrdFlatHashMapMask mask = 0;
+	for (auto i: grd_range(GRD_FLAT_HASH_MAP_GROUP_WIDTH)) {
+		if (group[i] == tag) {
+			mask |= 1u << i;
+		}
+	}
+	return mask;
+#endif
+}
+
+GRD_DEDUP GrdFlatHashMapMask grd_flat_hash_map_match_empty(GrdFlatHashMapCtrl* group) {
+	return grd_flat_hash_map_match(group, GRD_FLAT_HASH_MAP_CTRL_EMPTY);
+}
+
+// Empty and deleted tags are the only negative ones.
+GRD_DEDUP GrdFlatHashMapMask grd_flat_hash_map_match_empty_or_deleted(GrdFlatHashMapCtrl* group) {
+#if GRD_ARCH_X64
+	__m128i ctrl = _mm_loadu_si128((__m128i*) group);
+	return _mm_movemask_epi8(ctrl);
+#elif GRD_ARCH_ARM64
+	int8x16_t ctrl = vld1q_s8(group);
+	return grd_flat_hash_map_neon_movemask(vcltzq_s8(ctrl));
+#else
+	GrdFlatHashMapMask mask = 0;
+	for (auto i: grd_range(GRD_FLAT_HASH_MAP_GROUP_WIDTH)) {
+		if (group[i] < 0) {
+			mask |= 1u << i;
+		}
+	}
+	return mask;
+#endif
+}
+
+template <typename K, typename V>
+struct GrdFlatHashMapEntry {
+	K key;
+	V value;
+};
+
+template <typename K, typename V>
+struct GrdFlatHashMap {
+	using Entry = GrdFlatHashMapEntry<K, V>;
+
+	GrdAllocator        allocator   = c_allocator;
+	// |capacity| + GROUP_WIDTH tags, last GROUP_WIDTH tags mirror the first ones,
+	//   so a group can be loaded starting from any slot without wrapping around.
+	GrdFlatHashMapCtrl* ctrl        = NULL;
+	Entry*              data        = NULL;
+	// Always a power of two once allocated.
+	s64                 capacity    = 0;
+	s64                 count       = 0;
+	// Empty slots left before we have to rehash, deleted slots count as occupied.
+	s64                 growth_left = 0;
+	GrdCodeLoc          loc = grd_caller_loc();
+
+	void free() {
+		if (ctrl) {
+			GrdFree(allocator, ctrl, loc);
+			ctrl = NULL;
+			data = NULL;
+		}
+		*this = {};
+	}
+
+	GrdGenerator<Entry*> iterate() {
+		auto xxx = this; // See GrdHashMap::iterate().
+		for (auto i: grd_range(xxx->capacity)) {
+			if (xxx->ctrl[i] >= 0) {
+				co_yield &xxx->data[i];
+			}
+		}
+	}
+};
+
+GRD_DEDUP s64 grd_flat_hash_map_max_load(s64 capacity) {
+	// 7/8 max load factor.
+	return capacity - capacity / 8;
+}
+
+GRD_DEDUP GrdFlatHashMapCtrl grd_flat_hash_map_h2(GrdHash64 hash) {
+	return GrdFlatHashMapCtrl(hash & 0x7f);
+}
+
+GRD_DEDUP u64 grd_flat_hash_map_h1(GrdHash64 hash) {
+	return hash >> 7;
+}
+
+template <typename K, typename V>
+GRD_DEDUP void grd_flat_hash_map_set_ctrl(GrdFlatHashMap<K, V>* map, s64 idx, GrdFlatHashMapCtrl tag) {
+	s64 mask = map->capacity - 1;
+	map->ctrl[idx] = tag;
+	map->ctrl[((idx - GRD_FLAT_HASH_MAP_GROUP_WIDTH) & mask) + GRD_FLAT_HASH_MAP_GROUP_WIDTH] = tag;
+}
+
+// Control bytes and slots share one allocation.
+template <typename K, typename V>
+GRD_DEDUP void grd_flat_hash_map_alloc(GrdFlatHashMap<K, V>* map, s64 capacity) {
+	using Entry = GrdFlatHashMapEntry<K, V>;
+	assert(grd_is_power_of_two(capacity));
+	assert(capacity >= GRD_FLAT_HASH_MAP_GROUP_WIDTH);
+
+	u64 ctrl_size = grd_align(capacity + GRD_FLAT_HASH_MAP_GROUP_WIDTH, alignof(Entry));
+	void* mem = GrdMalloc(map->allocator, ctrl_size + sizeof(Entry) * capacity, map->loc);
+	map->ctrl = (GrdFlatHashMapCtrl*) mem;
+	map->data = (Entry*) grd_ptr_add(mem, ctrl_size);
+	map->capacity = capacity;
+	map->count = 0;
+	map->growth_left = grd_flat_hash_map_max_load(capacity);
+	memset(map->ctrl, (u8) GRD_FLAT_HASH_MAP_CTRL_EMPTY, capacity + GRD_FLAT_HASH_MAP_GROUP_WIDTH);
+}
+
+// Returns index of the first empty or deleted slot in |hash|'s probe sequence.
+template <typename K, typename V>
+GRD_DEDUP s64 grd_flat_hash_map_find_free_slot(GrdFlatHashMap<K, V>* map, GrdHash64 hash) {
+	s64 mask   = map->capacity - 1;
+	s64 pos    = grd_flat_hash_map_h1(hash) & mask;
+	s64 stride = 0;
+	while (true) {
+		auto free_mask = grd_flat_hash_map_match_empty_or_deleted(map->ctrl + pos);
+		if (free_mask) {
+			return (pos + grd_count_trailing_zeros(free_mask)) & mask;
+		}
+		// Triangular probing visits every group when capacity is a power of two.
+		stride += GRD_FLAT_HASH_MAP_GROUP_WIDTH;
+		pos = (pos + stride) & mask;
+	}
+}
+
+template <typename K, typename V>
+GRD_DEDUP void grd_flat_hash_map_rehash(GrdFlatHashMap<K, V>* map, s64 new_capacity) {
+	auto old_ctrl     = map->ctrl;
+	auto old_data     = map->data;
+	auto old_capacity = map->capacity;
+
+	grd_flat_hash_map_alloc(map, new_capacity);
+	for (auto i: grd_range(old_capacity)) {
+		if (old_ctrl[i] < 0) {
+			continue;
+		}
+		auto e = &old_data[i];
+		GrdHash64 hash = grd_hash_key(e->key);
+		s64 idx = grd_flat_hash_map_find_free_slot(map, hash);
+		grd_flat_hash_map_set_ctrl(map, idx, grd_flat_hash_map_h2(hash));
+		memcpy(&map->data[idx], e, sizeof(*e));
+		map->count += 1;
+		map->growth_left -= 1;
+	}
+	GrdFree(map->allocator, old_ctrl, map->loc);
+}
+
+template <typename K, typename V>
+GRD_DEDUP s64 grd_flat_hash_map_find(GrdFlatHashMap<K, V>* map, K key, GrdHash64 hash) {
+	s64 mask   = map->capacity - 1;
+	s64 pos    = grd_flat_hash_map_h1(hash) & mask;
+	s64 stride = 0;
+	auto tag   = grd_flat_hash_map_h2(hash);
+	while (true) {
+		auto group = map->ctrl + pos;
+		auto match = grd_flat_hash_map_match(group, tag);
+		while (match) {
+			s64 idx = (pos + grd_count_trailing_zeros(match)) & mask;
+			if (map->data[idx].key == key) {
+				return idx;
+			}
+			match &= match - 1;
+		}
+		if (grd_flat_hash_map_match_empty(group)) {
+			return -1;
+		}
+		stride += GRD_FLAT_HASH_MAP_GROUP_WIDTH;
+		pos = (pos + stride) & mask;
+	}
+}
+
+template <typename K, typename V>
+GRD_DEDUP GrdFlatHashMapEntry<K, V>* grd_get_entry(GrdFlatHashMap<K, V>* map, std::type_identity_t<K> key) {
+	if (!map->ctrl) {
+		return NULL;
+	}
+	s64 idx = grd_flat_hash_map_find(map, key, grd_hash_key(key));
+	if (idx == -1) {
+		return NULL;
+	}
+	return &map->data[idx];
+}
+
+template <typename K, typename V>
+GRD_DEDUP GrdFlatHashMapEntry<K, V>* grd_put_entry(GrdFlatHashMap<K, V>* map, std::type_identity_t<K> key) {
+	if (!map->ctrl) {
+		// |capacity| set before the first put is used as a hint.
+		s64 capacity = grd_max(map->capacity, GRD_FLAT_HASH_MAP_GROUP_WIDTH);
+		grd_flat_hash_map_alloc(map, grd_next_power_of_two(capacity));
+	}
+
+	GrdHash64 hash = grd_hash_key(key);
+	s64 idx = grd_flat_hash_map_find(map, key, hash);
+	if (idx != -1) {
+		return &map->data[idx];
+	}
+
+	idx = grd_flat_hash_map_find_free_slot(map, hash);
+	if (map->growth_left == 0 && map->ctrl[idx] != GRD_FLAT_HASH_MAP_CTRL_DELETED) {
+		// If most of the used up slots are tombstones,
+		//   rehashing in place is enough to get them back.
+		s64 new_capacity = map->capacity;
+		if (map->count * 2 >= grd_flat_hash_map_max_load(map->capacity)) {
+			new_capacity *= 2;
+		}
+		grd_flat_hash_map_rehash(map, new_capacity);
+		idx = grd_flat_hash_map_find_free_slot(map, hash);
+	}
+
+	if (map->ctrl[idx] == GRD_FLAT_HASH_MAP_CTRL_EMPTY) {
+		map->growth_left -= 1;
+	}
+	map->count += 1;
+	grd_flat_hash_map_set_ctrl(map, idx, grd_flat_hash_map_h2(hash));
+	auto e = &map->data[idx];
+	e->key = key;
+	return e;
+}
+
+// Returns true if |key| was in the map, its value is copied to |out_value|.
+template <typename K, typename V>
+GRD_DEDUP bool grd_remove(GrdFlatHashMap<K, V>* map, std::type_identity_t<K> key, V* out_value = NULL) {
+	if (!map->ctrl) {
+		return false;
+	}
+	s64 idx = grd_flat_hash_map_find(map, key, grd_hash_key(key));
+	if (idx == -1) {
+		return false;
+	}
+	if (out_value) {
+		*out_value = map->data[idx].value;
+	}
+
+	// If there was never a full group around |idx|, no probe sequence
+	//   could have walked past it, so the slot can become empty again.
+	s64 mask = map->capacity - 1;
+	s64 idx_before = (idx - GRD_FLAT_HASH_MAP_GROUP_WIDTH) & mask;
+	auto empty_after  = grd_flat_hash_map_match_empty(map->ctrl + idx);
+	auto empty_before = grd_flat_hash_map_match_empty(map->ctrl + idx_before);
+	bool was_never_full = empty_before && empty_after &&
+		(grd_count_trailing_zeros(empty_after) + grd_count_leading_zeros(u64(empty_before) << 48)) < GRD_FLAT_HASH_MAP_GROUP_WIDTH;
+
+	if (was_never_full) {
+		grd_flat_hash_map_set_ctrl(map, idx, GRD_FLAT_HASH_MAP_CTRL_EMPTY);
+		map->growth_left += 1;
+	} else {
+		grd_flat_hash_map_set_ctrl(map, idx, GRD_FLAT_HASH_MAP_CTRL_DELETED);
+	}
+	map->count -= 1;
+	return true;
+}
+
+template <typename K, typename V>
+GRD_DEDUP V* grd_put(GrdFlatHashMap<K, V>* map, std::type_identity_t<K> key) {
+	return &grd_put_entry(map, key)->value;
+}
+
+template <typename K, typename V>
+GRD_DEDUP V* grd_put(GrdFlatHashMap<K, V>* map, std::type_identity_t<K> key, std::type_identity_t<V> value) {
+	V* result = grd_put(map, key);
+	*result = value;
+	return result;
+}
+
+template <typename K, typename V>
+GRD_DEDUP V* grd_get(GrdFlatHashMap<K, V>* map, std::type_identity_t<K> key) {
+	auto* e = grd_get_entry(map, key);
+	if (!e) {
+		return NULL;
+	}
+	return &e->value;
+}
+
+template <typename K, typename V>
+GRD_DEDUP s64 grd_len(GrdFlatHashMap<K, V> map) {
+	return map.count;
+}
+
+struct GrdFlatHashMapType: GrdMapType {
+	s32 key_offset   = 0;
+	s32 value_offset = 0;
+	u32 entry_size   = 0;
+};
+
+template <typename K, typename V>
+GRD_DEDUP GrdFlatHashMapType* grd_reflect_create_type(GrdFlatHashMap<K, V>* x) {
+	return grd_reflect_register_type<GrdFlatHashMap<K, V>, GrdFlatHashMapType>("");
+}
+
+template <typename K, typename V>
+GRD_DEDUP void grd_reflect_type(GrdFlatHashMap<K, V>* x, GrdFlatHashMapType* type) {
+	type->key   = grd_reflect_type_of<K>();
+	type->value = grd_reflect_type_of<V>();
+	type->name  = grd_heap_sprintf("GrdFlatHashMap<%s, %s>", type->key->name, type->value->name);
+	type->subkind = "flat_hash_map";
+
+	using Map = GrdFlatHashMap<K, V>;
+	using Entry = Map::Entry;
+
+	type->key_offset   = offsetof(Entry, key);
+	type->value_offset = offsetof(Entry, value);
+	type->entry_size   = sizeof(Entry);
+
+	type->get_count = [](void* map) {
+		auto casted = (GrdFlatHashMap<int, int>*) map;
+		return grd_len(*casted);
+	};
+
+	type->get_capacity = [](void* map) {
+		auto casted = (GrdFlatHashMap<int, int>*) map;
+		return casted->capacity;
+	};
+
+	type->iterate = [](void* map) -> GrdGenerator<GrdMapType::Item*> {
+		auto casted_map = (Map*) map;
+
+		GrdMapType::Item item;
+
+		for (auto i: grd_range(casted_map->capacity)) {
+			if (casted_map->ctrl[i] >= 0) {
+				auto* entry = &casted_map->data[i];
+				item.key   = &entry->key;
+				item.value = &entry->value;
+				co_yield &item;
+			}
+		}
+	};
+}
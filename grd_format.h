@@ -651,6 +651,15 @@ GRD_DEDUP void grd_format_span(GrdFormatter* formatter, GrdSpanType* type, void*
 	printer.tail();
 }
 
+GRD_DEDUP void grd_format_set(GrdFormatter* formatter, GrdSetType* type, void* thing) {
+	auto printer = grd_make_array_printer(formatter);
+	printer.head(grd_make_string(type->name));
+	for (void* item: type->iterate(thing)) {
+		printer.item(grd_make_any(type->inner, item));
+	}
+	printer.tail();
+}
+
 GRD_DEDUP void grd_format_tuple(GrdFormatter* formatter, GrdStructType* type, void* thing) {
 	auto printer = grd_make_tuple_printer(formatter);
 	printer.head();
@@ -947,6 +956,9 @@ GRD_DEDUP void grd_format_item(GrdFormatter* formatter, GrdType* type, void* thi
 	} else if (real_type->kind == GrdSpanType::KIND) {
 		auto casted = (GrdArrayType*) real_type;
 		grd_format_span(formatter, casted, thing, spec);
+	} else if (real_type->kind == GrdSetType::KIND) {
+		auto casted = (GrdSetType*) real_type;
+		grd_format_set(formatter, casted, thing);
 	} else if (real_type->kind == GrdPointerType::KIND) {
 		auto casted = (GrdPointerType*) real_type;
 		auto inner_type = grd_reflect_get_pointer_inner_type_with_indirection_level(casted, NULL);
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "grd_base.h"
+#include "grd_span.h"
+#include <type_traits>
+
+// Read-only map built at compile time from a literal key list.
+// Keys are placed with a minimal perfect hash (hash and displace),
+//   so a lookup is one key hash, one integer mix and one key compare.
+// Declare maps as constinit (or constexpr) so nothing runs at startup:
+//
+//   GRD_DEDUP constinit auto MAP = grd_make_frozen_map<GrdString, s32>({
+//       { "a"_b, 1 },
+//       { "b"_b, 2 },
+//   });
+
+template <typename K, typename V>
+struct GrdFrozenMapItem {
+	K key;
+	V value;
+};
+
+template <typename K, typename V, s64 N>
+struct GrdFrozenMap {
+	static_assert(N > 0);
+
+	K   keys[N]   = {};
+	V   values[N] = {};
+	// Per bucket displacement of the key hash.
+	u32 seeds[N]  = {};
+};
+
+// splitmix64 finalizer.
+GRD_DEDUP constexpr u64 grd_frozen_map_mix(u64 x) {
+	x ^= x >> 30;
+	x *= 0xbf58'476d'1ce4'e5b9;
+	x ^= x >> 27;
+	x *= 0x94d0'49bb'1331'11eb;
+	x ^= x >> 31;
+	return x;
+}
+
+// Maps |x| into [0, n) without a division.
+GRD_DEDUP constexpr s64 grd_frozen_map_reduce(u64 x, s64 n) {
+	return s64(((x >> 32) * u64(n)) >> 32);
+}
+
+template <typename T>
+concept GrdFrozenMapIntKey = std::is_integral_v<T> || std::is_enum_v<T>;
+
+template <GrdFrozenMapIntKey T>
+GRD_DEDUP constexpr u64 grd_frozen_map_hash_key(T key) {
+	return grd_frozen_map_mix(u64(key));
+}
+
+template <GrdFrozenMapIntKey T>
+GRD_DEDUP constexpr bool grd_frozen_map_key_equal(T a, T b) {
+	return a == b;
+}
+
+// GrdString, GrdUnicodeString and other spans of integers.
+// Hashed element by element so the same code runs at compile time.
+template <GrdFrozenMapIntKey T>
+GRD_DEDUP constexpr u64 grd_frozen_map_hash_key(GrdSpan<T> key) {
+	u64 h = 0xcbf2'9ce4'8422'2325 ^ u64(key.count);
+	for (s64 i = 0; i < key.count; i++) {
+		h = (h ^ u64(key.data[i])) * 0x100'0000'01b3;
+	}
+	return grd_frozen_map_mix(h);
+}
+
+template <GrdFrozenMapIntKey T>
+GRD_DEDUP constexpr bool grd_frozen_map_key_equal(GrdSpan<T> a, GrdSpan<T> b) {
+	if (a.count != b.count) {
+		return false;
+	}
+	for (s64 i = 0; i < a.count; i++) {
+		if (a.data[i] != b.data[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+GRD_DEDUP constexpr s64 grd_frozen_map_slot(u64 hash, u32 seed, s64 n) {
+	return grd_frozen_map_reduce(grd_frozen_map_mix(hash ^ seed), n);
+}
+
+// Not constexpr on purpose: reaching it from grd_make_frozen_map() fails compilation.
+GRD_DEDUP void grd_frozen_map_duplicate_key() {}
+GRD_DEDUP void grd_frozen_map_no_seed_found() {}
+
+GRD_DEDUP constexpr u32 GRD_FROZEN_MAP_MAX_SEED = 1 << 20;
+
+template <typename K, typename V, s64 N>
+GRD_DEDUP consteval GrdFrozenMap<K, V, N> grd_make_frozen_map(const GrdFrozenMapItem<K, V> (&items)[N]) {
+	GrdFrozenMap<K, V, N> map;
+
+	u64 hashes[N] = {};
+	s64 buckets[N] = {};
+	s64 bucket_sizes[N] = {};
+	for (s64 i = 0; i < N; i++) {
+		for (s64 j = 0; j < i; j++) {
+			if (grd_frozen_map_key_equal(items[i].key, items[j].key)) {
+				grd_frozen_map_duplicate_key();
+			}
+		}
+		hashes[i] = grd_frozen_map_hash_key(items[i].key);
+		buckets[i] = grd_frozen_map_reduce(hashes[i], N);
+		bucket_sizes[buckets[i]] += 1;
+	}
+
+	// Place the biggest buckets first while there are many free slots.
+	s64 order[N] = {};
+	for (s64 i = 0; i < N; i++) {
+		order[i] = i;
+	}
+	for (s64 i = 0; i < N; i++) {
+		for (s64 j = i + 1; j < N; j++) {
+			if (bucket_sizes[order[j]] > bucket_sizes[order[i]]) {
+				s64 tmp = order[i];
+				order[i] = order[j];
+				order[j] = tmp;
+			}
+		}
+	}
+
+	bool taken[N] = {};
+	for (s64 oi = 0; oi < N; oi++) {
+		s64 bucket = order[oi];
+		if (bucket_sizes[bucket] == 0) {
+			break;
+		}
+		bool placed = false;
+		for (u32 seed = 0; seed < GRD_FROZEN_MAP_MAX_SEED && !placed; seed++) {
+			s64 slots[N] = {};
+			s64 slot_count = 0;
+			bool ok = true;
+			for (s64 i = 0; i < N && ok; i++) {
+				if (buckets[i] != bucket) {
+					continue;
+				}
+				s64 slot = grd_frozen_map_slot(hashes[i], seed, N);
+				if (taken[slot]) {
+					ok = false;
+				}
+				for (s64 j = 0; j < slot_count && ok; j++) {
+					if (slots[j] == slot) {
+						ok = false;
+					}
+				}
+				slots[slot_count++] = slot;
+			}
+			if (!ok) {
+				continue;
+			}
+			map.seeds[bucket] = seed;
+			for (s64 i = 0; i < N; i++) {
+				if (buckets[i] != bucket) {
+					continue;
+				}
+				s64 slot = grd_frozen_map_slot(hashes[i], seed, N);
+				taken[slot] = true;
+				map.keys[slot] = items[i].key;
+				map.values[slot] = items[i].value;
+			}
+			placed = true;
+		}
+		if (!placed) {
+			grd_frozen_map_no_seed_found();
+		}
+	}
+	return map;
+}
+
+// Builds a map from values that carry their own key, |key_of(value)| returns it.
+template <typename K, typename V, s64 N>
+GRD_DEDUP consteval GrdFrozenMap<K, V, N> grd_make_frozen_map(const V (&values)[N], auto key_of) {
+	GrdFrozenMapItem<K, V> items[N] = {};
+	for (s64 i = 0; i < N; i++) {
+		items[i] = { key_of(values[i]), values[i] };
+	}
+	return grd_make_frozen_map<K, V, N>(items);
+}
+
+// Returns slot index of |key| or -1.
+template <typename K, typename V, s64 N>
+GRD_DEDUP constexpr s64 grd_frozen_map_find(const GrdFrozenMap<K, V, N>* map, std::type_identity_t<K> key) {
+	u64 hash = grd_frozen_map_hash_key(key);
+	s64 slot = grd_frozen_map_slot(hash, map->seeds[grd_frozen_map_reduce(hash, N)], N);
+	if (!grd_frozen_map_key_equal(map->keys[slot], key)) {
+		return -1;
+	}
+	return slot;
+}
+
+template <typename K, typename V, s64 N>
+GRD_DEDUP constexpr V* grd_get(GrdFrozenMap<K, V, N>* map, std::type_identity_t<K> key) {
+	s64 slot = grd_frozen_map_find(map, key);
+	return slot >= 0 ? &map->values[slot] : NULL;
+}
+
+template <typename K, typename V, s64 N>
+GRD_DEDUP constexpr const V* grd_get(const GrdFrozenMap<K, V, N>* map, std::type_identity_t<K> key) {
+	s64 slot = grd_frozen_map_find(map, key);
+	return slot >= 0 ? &map->values[slot] : NULL;
+}
+
+template <typename K, typename V, s64 N>
+GRD_DEDUP constexpr bool grd_contains(const GrdFrozenMap<K, V, N>* map, std::type_identity_t<K> key) {
+	return grd_frozen_map_find(map, key) >= 0;
+}
+
+template <typename K, typename V, s64 N>
+GRD_DEDUP constexpr s64 grd_len(const GrdFrozenMap<K, V, N>& map) {
+	return N;
+}
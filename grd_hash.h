@@ -82,6 +82,32 @@ GRD_DEDUP void grd_update(GrdHasher* h, T x) {
 	grd_update(h, &x, sizeof(T));
 }
 
+// Same as calling grd_update() for every argument in order.
+// Runs of plain data arguments are copied next to each other
+//   and fed to the hasher with one call, so padding between them is skipped.
+template <typename... Args>
+GRD_DEDUP void grd_update_fused(GrdHasher* h, Args&... args) {
+	constexpr u64 buf_size = (u64(0) + ... + (GrdPodHashable<Args> ? sizeof(Args) : 0));
+	u8  buf[buf_size > 0 ? buf_size : 1];
+	u64 filled = 0;
+	auto add = [&]<typename T>(T& x) {
+		if constexpr (GrdPodHashable<T>) {
+			memcpy(buf + filled, &x, sizeof(T));
+			filled += sizeof(T);
+		} else {
+			if (filled > 0) {
+				grd_update(h, buf, filled);
+				filled = 0;
+			}
+			grd_update(h, x);
+		}
+	};
+	(add(args), ...);
+	if (filled > 0) {
+		grd_update(h, buf, filled);
+	}
+}
+
 GRD_DEDUP constexpr GrdHash128 grd_spookyhash_seed = {
 	.lower = 0x23ad'aad3'dad3'7089,
 	.upper = 0x7200'a02f'79b2'70c5,
@@ -123,6 +149,79 @@ GRD_DEDUP GrdHash64 grd_hash64(auto thing) {
 	return grd_hash128(thing).lower;
 }
 
+// Fast hashes below are meant for hash table keys, not for content hashing.
+// Their values are not compatible with grd_hash64() and may change.
+
+// 64x64->128 multiply, returns upper half xor lower half.
+GRD_DEDUP u64 grd_hash_mum(u64 a, u64 b) {
+#if GRD_COMPILER_MSVC && GRD_ARCH_X64
+	u64 hi;
+	u64 lo = _umul128(a, b, &hi);
+	return hi ^ lo;
+#elif GRD_COMPILER_MSVC
+	return __umulh(a, b) ^ (a * b);
+#else
+	__uint128_t r = (__uint128_t) a * b;
+	return u64(r >> 64) ^ u64(r);
+#endif
+}
+
+GRD_DEDUP constexpr u64 GRD_FAST_HASH_SECRET_0 = 0xa076'1d64'78bd'642f;
+GRD_DEDUP constexpr u64 GRD_FAST_HASH_SECRET_1 = 0xe703'7ed1'a0b4'28db;
+GRD_DEDUP constexpr u64 GRD_FAST_HASH_SECRET_2 = 0x8ebc'6af0'9c88'c6e3;
+
+// Single multiply hash of an integer or a pointer.
+// Every bit of the result depends on every bit of |x|.
+GRD_DEDUP GrdHash64 grd_hash_mix64(u64 x) {
+	return grd_hash_mum(x ^ GRD_FAST_HASH_SECRET_0, GRD_FAST_HASH_SECRET_1);
+}
+
+GRD_DEDUP u64 grd_hash_read_u64(u8* p) {
+	u64 x;
+	memcpy(&x, p, sizeof(x));
+	return x;
+}
+
+GRD_DEDUP u64 grd_hash_read_u32(u8* p) {
+	u32 x;
+	memcpy(&x, p, sizeof(x));
+	return x;
+}
+
+// Blobs above this size are hashed with SpookyHash by grd_hash64_fast().
+GRD_DEDUP constexpr u64 GRD_FAST_HASH_MAX_SIZE = 64;
+
+// wyhash-like hash for short keys, SpookyHash for long ones.
+GRD_DEDUP GrdHash64 grd_hash64_fast(void* data, u64 size) {
+	if (size > GRD_FAST_HASH_MAX_SIZE) {
+		return grd_hash64(data, size);
+	}
+	u8* p = (u8*) data;
+	u64 seed = GRD_FAST_HASH_SECRET_0;
+	u64 a = 0;
+	u64 b = 0;
+	if (size <= 16) {
+		if (size >= 4) {
+			// Two overlapping reads from each end cover 4..16 bytes.
+			u64 mid = (size >> 3) << 2;
+			a = (grd_hash_read_u32(p) << 32) | grd_hash_read_u32(p + mid);
+			b = (grd_hash_read_u32(p + size - 4) << 32) | grd_hash_read_u32(p + size - 4 - mid);
+		} else if (size > 0) {
+			a = (u64(p[0]) << 16) | (u64(p[size >> 1]) << 8) | u64(p[size - 1]);
+		}
+	} else {
+		u64 i = size;
+		while (i > 16) {
+			seed = grd_hash_mum(grd_hash_read_u64(p) ^ GRD_FAST_HASH_SECRET_1, grd_hash_read_u64(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+		a = grd_hash_read_u64(p + i - 16);
+		b = grd_hash_read_u64(p + i - 8);
+	}
+	return grd_hash_mum(GRD_FAST_HASH_SECRET_1 ^ size, grd_hash_mum(a ^ GRD_FAST_HASH_SECRET_1, b ^ seed) ^ GRD_FAST_HASH_SECRET_2);
+}
+
 template <typename T>
 GRD_DEDUP void grd_hash_fp_naive(GrdHasher* h, T num) {
 	static_assert(std::is_same_v<T, f32> || std::is_same_v<T, f64>);
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "grd_hash.h"
+#include "grd_span.h"
+
+// Hashes many keys of the same type at once.
+// Results are identical to grd_hash64(key).
+//
+// Plain data keys shorter than SPOOKYHASH_BUFFER_SIZE take SpookyHash's short path,
+//   which has the same control flow for every key of a type,
+//   so 4 keys are hashed in 4 SIMD lanes (AVX2 on x64, NEON on arm64).
+// Other keys and the last count % 4 keys are hashed one by one.
+
+#if (GRD_COMPILER_CLANG || GRD_COMPILER_GCC) && (GRD_ARCH_X64 || GRD_ARCH_ARM64)
+	#define GRD_HASH_MANY_SIMD 1
+#else
+	// MSVC doesn't have vector extensions.
+	#define GRD_HASH_MANY_SIMD 0
+#endif
+
+#if GRD_HASH_MANY_SIMD
+
+#if GRD_ARCH_X64
+	// AVX2 is checked at runtime, see grd_hash_many_has_simd().
+	#define GRD_HASH_MANY_TARGET __attribute__((target("avx2")))
+#else
+	#define GRD_HASH_MANY_TARGET
+#endif
+
+GRD_DEDUP constexpr s64 GRD_HASH_MANY_LANES = 4;
+
+using GrdHashLanes = u64 __attribute__((vector_size(GRD_HASH_MANY_LANES * sizeof(u64))));
+
+#define GRD_HASH_LANES_ROTATE(x, k) (((x) << (k)) | ((x) >> (64 - (k))))
+
+GRD_DEDUP bool grd_hash_many_has_simd() {
+#if GRD_ARCH_X64
+	static bool has_avx2 = __builtin_cpu_supports("avx2");
+	return has_avx2;
+#else
+	return true;
+#endif
+}
+
+// Loads |size| bytes at |offset| of every lane's key, zero extended.
+template <u64 size>
+GRD_HASH_MANY_TARGET GRD_FORCE_INLINE GRD_DEDUP GrdHashLanes grd_hash_lanes_load(u8** keys, u64 offset) {
+	static_assert(size > 0 && size <= 8);
+	GrdHashLanes result;
+	for (s64 i = 0; i < GRD_HASH_MANY_LANES; i++) {
+		u64 x = 0;
+		memcpy(&x, keys[i] + offset, size);
+		result[i] = x;
+	}
+	return result;
+}
+
+// spookyhash_short_mix() on lanes.
+GRD_HASH_MANY_TARGET GRD_FORCE_INLINE GRD_DEDUP void grd_hash_lanes_short_mix(GrdHashLanes& h0, GrdHashLanes& h1, GrdHashLanes& h2, GrdHashLanes& h3) {
+	h2 = GRD_HASH_LANES_ROTATE(h2, 50); h2 += h3; h0 ^= h2;
+	h3 = GRD_HASH_LANES_ROTATE(h3, 52); h3 += h0; h1 ^= h3;
+	h0 = GRD_HASH_LANES_ROTATE(h0, 30); h0 += h1; h2 ^= h0;
+	h1 = GRD_HASH_LANES_ROTATE(h1, 41); h1 += h2; h3 ^= h1;
+	h2 = GRD_HASH_LANES_ROTATE(h2, 54); h2 += h3; h0 ^= h2;
+	h3 = GRD_HASH_LANES_ROTATE(h3, 48); h3 += h0; h1 ^= h3;
+	h0 = GRD_HASH_LANES_ROTATE(h0, 38); h0 += h1; h2 ^= h0;
+	h1 = GRD_HASH_LANES_ROTATE(h1, 37); h1 += h2; h3 ^= h1;
+	h2 = GRD_HASH_LANES_ROTATE(h2, 62); h2 += h3; h0 ^= h2;
+	h3 = GRD_HASH_LANES_ROTATE(h3, 34); h3 += h0; h1 ^= h3;
+	h0 = GRD_HASH_LANES_ROTATE(h0, 5);  h0 += h1; h2 ^= h0;
+	h1 = GRD_HASH_LANES_ROTATE(h1, 36); h1 += h2; h3 ^= h1;
+}
+
+// spookyhash_short_end() on lanes.
+GRD_HASH_MANY_TARGET GRD_FORCE_INLINE GRD_DEDUP void grd_hash_lanes_short_end(GrdHashLanes& h0, GrdHashLanes& h1, GrdHashLanes& h2, GrdHashLanes& h3) {
+	h3 ^= h2; h2 = GRD_HASH_LANES_ROTATE(h2, 15); h3 += h2;
+	h0 ^= h3; h3 = GRD_HASH_LANES_ROTATE(h3, 52); h0 += h3;
+	h1 ^= h0; h0 = GRD_HASH_LANES_ROTATE(h0, 26); h1 += h0;
+	h2 ^= h1; h1 = GRD_HASH_LANES_ROTATE(h1, 51); h2 += h1;
+	h3 ^= h2; h2 = GRD_HASH_LANES_ROTATE(h2, 28); h3 += h2;
+	h0 ^= h3; h3 = GRD_HASH_LANES_ROTATE(h3, 9);  h0 += h3;
+	h1 ^= h0; h0 = GRD_HASH_LANES_ROTATE(h0, 47); h1 += h0;
+	h2 ^= h1; h1 = GRD_HASH_LANES_ROTATE(h1, 54); h2 += h1;
+	h3 ^= h2; h2 = GRD_HASH_LANES_ROTATE(h2, 32); h3 += h2;
+	h0 ^= h3; h3 = GRD_HASH_LANES_ROTATE(h3, 25); h0 += h3;
+	h1 ^= h0; h0 = GRD_HASH_LANES_ROTATE(h0, 63); h1 += h0;
+}
+
+// spookyhash_short() of GRD_HASH_MANY_LANES keys of |size| bytes.
+// Returns how many keys were hashed, the rest is left to the caller.
+template <u64 size>
+GRD_HASH_MANY_TARGET GRD_DEDUP s64 grd_hash64_many_simd(u8* keys, s64 count, GrdHash64* out) {
+	static_assert(size < SPOOKYHASH_BUFFER_SIZE);
+	constexpr u64 constant = SPOOKYHASH_CONSTANT;
+	// Bytes left after 32 byte blocks and an optional 16 byte block.
+	constexpr u64 remainder = (size > 15 && size % 32 >= 16) ? size % 32 - 16 : size % 32;
+
+	s64 i = 0;
+	for (; i + GRD_HASH_MANY_LANES <= count; i += GRD_HASH_MANY_LANES) {
+		u8* lanes[GRD_HASH_MANY_LANES];
+		for (s64 l = 0; l < GRD_HASH_MANY_LANES; l++) {
+			lanes[l] = keys + (i + l) * size;
+		}
+		GrdHashLanes a = grd_spookyhash_seed.lower - GrdHashLanes{};
+		GrdHashLanes b = grd_spookyhash_seed.upper - GrdHashLanes{};
+		GrdHashLanes c = constant - GrdHashLanes{};
+		GrdHashLanes d = constant - GrdHashLanes{};
+
+		u64 offset = 0;
+		if constexpr (size > 15) {
+			for (; offset + 32 <= size; offset += 32) {
+				c += grd_hash_lanes_load<8>(lanes, offset);
+				d += grd_hash_lanes_load<8>(lanes, offset + 8);
+				grd_hash_lanes_short_mix(a, b, c, d);
+				a += grd_hash_lanes_load<8>(lanes, offset + 16);
+				b += grd_hash_lanes_load<8>(lanes, offset + 24);
+			}
+			if constexpr (size % 32 >= 16) {
+				c += grd_hash_lanes_load<8>(lanes, offset);
+				d += grd_hash_lanes_load<8>(lanes, offset + 8);
+				grd_hash_lanes_short_mix(a, b, c, d);
+				offset += 16;
+			}
+		}
+
+		d += u64(size) << 56;
+		if constexpr (remainder == 0) {
+			c += constant;
+			d += constant;
+		} else {
+			c += grd_hash_lanes_load<grd_min(remainder, 8ull)>(lanes, offset);
+			if constexpr (remainder > 8) {
+				d += grd_hash_lanes_load<remainder - 8>(lanes, offset + 8);
+			}
+		}
+		grd_hash_lanes_short_end(a, b, c, d);
+		memcpy(out + i, &a, sizeof(a));
+	}
+	return i;
+}
+
+#endif // GRD_HASH_MANY_SIMD
+
+// |out| must have at least as many items as |keys|.
+template <typename T>
+GRD_DEDUP void grd_hash64_many(GrdSpan<T> keys, GrdSpan<GrdHash64> out) {
+	assert(grd_len(out) >= grd_len(keys));
+	s64 done = 0;
+#if GRD_HASH_MANY_SIMD
+	if constexpr (GrdPodHashable<T> && sizeof(T) < SPOOKYHASH_BUFFER_SIZE) {
+		if (grd_hash_many_has_simd()) {
+			done = grd_hash64_many_simd<sizeof(T)>((u8*) keys.data, grd_len(keys), out.data);
+		}
+	}
+#endif
+	for (s64 i = done; i < grd_len(keys); i++) {
+		out.data[i] = grd_hash64(keys.data[i]);
+	}
+}
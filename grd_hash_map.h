@@ -3,10 +3,21 @@
 #include "grd_hash.h"
 #include "grd_allocator.h"
 #include "grd_reflect.h"
+#include "grd_reflect_hash.h"
+#include "grd_span.h"
 
 GRD_DEDUP constexpr GrdHash64 HASH_MAP_HASH_EMPTY = 0;
 GRD_DEDUP constexpr GrdHash64 HASH_MAP_SLOT_HASH_FIRST_OCCUPIED = 1;
 
+enum GrdHashMapLayout: s32 {
+	// Key, value and hash of a slot are stored together in GrdHashMapEntry.
+	GRD_HASH_MAP_LAYOUT_ENTRIES = 0,
+	// Hashes, keys and values are stored in three parallel arrays,
+	//   so probing doesn't pull values into the cache.
+	// Use it when values are large compared to keys.
+	GRD_HASH_MAP_LAYOUT_SPLIT   = 1,
+};
+
 template <typename K, typename V>
 struct GrdHashMapEntry {
 	K         key;
@@ -18,40 +29,215 @@ struct GrdHashMapEntry {
 	}
 };
 
+// Map with empty values is a set, don't waste space on them.
+template <typename K>
+struct GrdHashMapEntry<K, GrdEmptyStruct> {
+	K                                    key;
+	GrdHash64                            normalized_hash;
+	GRD_NO_UNIQUE_ADDRESS GrdEmptyStruct value;
+
+	bool is_occupied() {
+		return normalized_hash != HASH_MAP_HASH_EMPTY;
+	}
+};
+
+// What GRD_HASH_MAP_LAYOUT_SPLIT map yields from iterate().
+template <typename K, typename V>
+struct GrdHashMapEntryView {
+	K&         key;
+	V&         value;
+	GrdHash64& normalized_hash;
+};
+
+template <typename K, typename V, GrdHashMapLayout Layout>
+struct GrdHashMapStorage;
+
 template <typename K, typename V>
-struct GrdHashMap {
+struct GrdHashMapStorage<K, V, GRD_HASH_MAP_LAYOUT_ENTRIES> {
+	GrdHashMapEntry<K, V>* data = NULL;
+
+	void* block() {
+		return data;
+	}
+};
+
+template <typename K, typename V>
+struct GrdHashMapStorage<K, V, GRD_HASH_MAP_LAYOUT_SPLIT> {
+	// All three arrays live in one allocation that starts at |hashes|.
+	GrdHash64* hashes = NULL;
+	K*         keys   = NULL;
+	V*         values = NULL;
+
+	void* block() {
+		return hashes;
+	}
+};
+
+template <typename K, typename V, GrdHashMapLayout Layout = GRD_HASH_MAP_LAYOUT_ENTRIES>
+struct GrdHashMap: GrdHashMapStorage<K, V, Layout> {
 	using Entry = GrdHashMapEntry<K, V>;
+	using IterateItem = std::conditional_t<Layout == GRD_HASH_MAP_LAYOUT_ENTRIES, Entry*, GrdHashMapEntryView<K, V>*>;
 
 	GrdAllocator allocator   = c_allocator;
-	Entry*       data        = NULL;
 	s64          capacity    = 0;
+	// Entries in both tables while incremental rehash is in progress.
 	s64          count       = 0;
 	f32          load_factor = 0.75;
 	GrdCodeLoc   loc = grd_caller_loc();
 
+	// Set to grow the map by moving a few entries on every put/remove
+	//   instead of rehashing everything in one put.
+	// Table of twice the capacity is allocated into |next_storage| when
+	//   the map is half full and is cleared a few slots per put.
+	// When it's swapped in, the previous table is kept in |old_storage|
+	//   until all of its entries are moved.
+	bool                            incremental_rehash = false;
+	GrdHashMapStorage<K, V, Layout> next_storage;
+	s64                             next_cleared = 0;
+	GrdHashMapStorage<K, V, Layout> old_storage;
+	s64                             old_capacity = 0;
+	s64                             old_count    = 0;
+	s64                             migrate_idx  = 0;
+
+	void* storage_block() {
+		return this->block();
+	}
+
 	void free() {
-		if (data) {
-			GrdFree(allocator, data, loc);
-			data  = NULL;
+		if (storage_block()) {
+			GrdFree(allocator, storage_block(), loc);
+		}
+		if (next_storage.block()) {
+			GrdFree(allocator, next_storage.block(), loc);
+		}
+		if (old_storage.block()) {
+			GrdFree(allocator, old_storage.block(), loc);
 		}
 		*this = {};
 	}
 
-	GrdGenerator<Entry*> iterate() {
+	GrdGenerator<IterateItem> iterate() {
 		auto xxx = this; // Crashes without copying |this|. I don't get it. Is |this| referenced???
 		for (auto i: grd_range(xxx->capacity)) {
-			auto* e = &xxx->data[i];
-			if (e->is_occupied()) {
-				co_yield e;
+			if constexpr (Layout == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+				auto* e = &xxx->data[i];
+				if (e->is_occupied()) {
+					co_yield e;
+				}
+			} else {
+				if (xxx->hashes[i] != HASH_MAP_HASH_EMPTY) {
+					GrdHashMapEntryView<K, V> view = { xxx->keys[i], xxx->values[i], xxx->hashes[i] };
+					co_yield &view;
+				}
+			}
+		}
+		// Entries that haven't been moved by incremental rehash yet.
+		auto old = &xxx->old_storage;
+		for (auto i: grd_range(xxx->old_capacity)) {
+			if constexpr (Layout == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+				auto* e = &old->data[i];
+				if (e->is_occupied()) {
+					co_yield e;
+				}
+			} else {
+				if (old->hashes[i] != HASH_MAP_HASH_EMPTY) {
+					GrdHashMapEntryView<K, V> view = { old->keys[i], old->values[i], old->hashes[i] };
+					co_yield &view;
+				}
 			}
 		}
 	}
 };
 
-template <typename K, typename V>
-GRD_DEDUP s64 grd_hash_map_get_home(GrdHashMap<K, V>* map, GrdHashMapEntry<K, V>* e) {
-	assert(map->capacity > 0);
-	return e->normalized_hash % map->capacity;
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP GrdHash64& grd_hash_map_slot_hash(GrdHashMap<K, V, L>* map, s64 idx) {
+	if constexpr (L == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+		return map->data[idx].normalized_hash;
+	} else {
+		return map->hashes[idx];
+	}
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP K& grd_hash_map_slot_key(GrdHashMap<K, V, L>* map, s64 idx) {
+	if constexpr (L == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+		return map->data[idx].key;
+	} else {
+		return map->keys[idx];
+	}
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP V& grd_hash_map_slot_value(GrdHashMap<K, V, L>* map, s64 idx) {
+	if constexpr (L == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+		return map->data[idx].value;
+	} else {
+		return map->values[idx];
+	}
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP bool grd_hash_map_slot_is_occupied(GrdHashMap<K, V, L>* map, s64 idx) {
+	return grd_hash_map_slot_hash(map, idx) != HASH_MAP_HASH_EMPTY;
+}
+
+// Map that shares |storage| with |map|, so slot functions can work on it.
+// Its |count| isn't written back.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP GrdHashMap<K, V, L> grd_hash_map_table_view(GrdHashMap<K, V, L>* map, GrdHashMapStorage<K, V, L> storage, s64 capacity, s64 count) {
+	GrdHashMap<K, V, L> view;
+	(GrdHashMapStorage<K, V, L>&) view = storage;
+	view.allocator   = map->allocator;
+	view.capacity    = capacity;
+	view.count       = count;
+	view.load_factor = map->load_factor;
+	view.loc         = map->loc;
+	return view;
+}
+
+// Table that incremental rehash is moving entries from.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP GrdHashMap<K, V, L> grd_hash_map_old_table(GrdHashMap<K, V, L>* map) {
+	return grd_hash_map_table_view(map, map->old_storage, map->old_capacity, map->old_count);
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP bool grd_hash_map_is_migrating(GrdHashMap<K, V, L>* map) {
+	return map->old_capacity > 0;
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_hash_map_copy_slot(GrdHashMap<K, V, L>* map, s64 dst, s64 src) {
+	if constexpr (L == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+		map->data[dst] = map->data[src];
+	} else {
+		map->hashes[dst] = map->hashes[src];
+		map->keys[dst]   = map->keys[src];
+		map->values[dst] = map->values[src];
+	}
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_hash_map_swap_slots(GrdHashMap<K, V, L>* map, s64 a, s64 b) {
+	if constexpr (L == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+		grd_swap(&map->data[a], &map->data[b]);
+	} else {
+		grd_swap(&map->hashes[a], &map->hashes[b]);
+		grd_swap(&map->keys[a],   &map->keys[b]);
+		grd_swap(&map->values[a], &map->values[b]);
+	}
+}
+
+// Capacity is always a power of two, so the home slot is
+//   the top bits of the hash multiplied by 2^64/phi (Fibonacci hashing).
+// Multiplication spreads keys even if grd_hash_key() of a custom key type
+//   only has good low bits.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_get_home(GrdHashMap<K, V, L>* map, GrdHash64 hash) {
+	assert(grd_is_power_of_two(map->capacity));
+	u32 shift = 64 - grd_count_trailing_zeros(map->capacity);
+	// Shift by 64 is undefined, it happens when capacity is 1.
+	return shift >= 64 ? 0 : s64((hash * 11400714819323198485ull) >> shift);
 }
 
 GRD_DEDUP GrdHash64 grd_hash_map_normalize_hash(GrdHash64 hash) {
@@ -61,12 +247,30 @@ GRD_DEDUP GrdHash64 grd_hash_map_normalize_hash(GrdHash64 hash) {
 	return hash;
 }
 
+// Picks the cheapest hash that is good enough for K at compile time.
+// Overload grd_hash_key for your type to customize it.
 template <typename K>
 GRD_DEDUP GrdHash64 grd_hash_key(K key) {
-	auto h = grd_hash64(key);
+	GrdHash64 h;
+	if constexpr ((std::is_integral_v<K> || std::is_enum_v<K>) && sizeof(K) <= sizeof(u64)) {
+		h = grd_hash_mix64(u64(key));
+	} else if constexpr (std::is_pointer_v<K>) {
+		h = grd_hash_mix64(u64(key));
+	} else if constexpr (GrdPodHashable<K>) {
+		h = grd_hash64_fast(&key, sizeof(key));
+	} else {
+		h = grd_hash64(key);
+	}
 	return grd_hash_map_normalize_hash(h);
 }
 
+// Strings and other spans of plain data are hashed as a single blob
+//   instead of item by item.
+template <GrdPodHashable T>
+GRD_DEDUP GrdHash64 grd_hash_key(GrdSpan<T> key) {
+	return grd_hash_map_normalize_hash(grd_hash64_fast(key.data, key.count * sizeof(T)));
+}
+
 GRD_DEDUP s64 grd_hash_map_distance_from_home(s64 home, s64 slot, s64 capacity) {
 	if (slot < home) {
 		return slot + (capacity - home);
@@ -75,78 +279,89 @@ GRD_DEDUP s64 grd_hash_map_distance_from_home(s64 home, s64 slot, s64 capacity)
 }
 
 GRD_DEDUP s64 grd_hash_map_next_index_wraparound(s64 idx, s64 capacity) {
-	return (idx + 1) % capacity;
+	return (idx + 1) & (capacity - 1);
 }
 
-template <typename K, typename V>
-GRD_DEDUP void grd_hash_map_clear_entries_hashes(GrdHashMapEntry<K, V>* entries, s64 capacity) {
-	for (auto i: grd_range(capacity)) {
-		entries[i].normalized_hash = HASH_MAP_HASH_EMPTY;
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_slot_distance(GrdHashMap<K, V, L>* map, s64 idx) {
+	return grd_hash_map_distance_from_home(grd_hash_map_get_home(map, grd_hash_map_slot_hash(map, idx)), idx, map->capacity);
+}
+
+// Size of the storage block of |capacity| slots.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP u64 grd_hash_map_storage_size(s64 capacity) {
+	if constexpr (L == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+		return sizeof(GrdHashMapEntry<K, V>) * capacity;
+	} else {
+		u64 keys_offset   = grd_align(sizeof(GrdHash64) * capacity, alignof(K));
+		u64 values_offset = grd_align(keys_offset + sizeof(K) * capacity, alignof(V));
+		return values_offset + sizeof(V) * capacity;
 	}
 }
 
-template <typename K, typename V>
-GRD_DEDUP GrdHashMapEntry<K, V>* grd_put_entry(GrdHashMap<K, V>* map, K key) {
-	if (!map->data) {
-		if (map->capacity <= 4) {
-			map->capacity = 16;
-		}
-		map->data = GrdAlloc<GrdHashMapEntry<K, V>>(map->allocator, map->capacity, map->loc);
-		grd_hash_map_clear_entries_hashes(map->data, map->capacity);
-		map->count = 0;
+// Storage pointers are derived from the block start and |capacity| only,
+//   so a block can be copied or mapped anywhere.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP GrdHashMapStorage<K, V, L> grd_hash_map_storage_at(void* block, s64 capacity) {
+	GrdHashMapStorage<K, V, L> storage;
+	if constexpr (L == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+		storage.data = (GrdHashMapEntry<K, V>*) block;
+	} else {
+		u64 keys_offset   = grd_align(sizeof(GrdHash64) * capacity, alignof(K));
+		u64 values_offset = grd_align(keys_offset + sizeof(K) * capacity, alignof(V));
+		storage.hashes = (GrdHash64*) block;
+		storage.keys   = (K*) grd_ptr_add(block, keys_offset);
+		storage.values = (V*) grd_ptr_add(block, values_offset);
 	}
-	
-	if (map->count >= map->capacity * map->load_factor) {
-		auto old_data = map->data;
-		auto old_capacity = map->capacity;
-		
-		map->capacity *= 2;
-		map->data = GrdAlloc<GrdHashMapEntry<K, V>>(map->allocator, map->capacity, map->loc);
-		grd_hash_map_clear_entries_hashes(map->data, map->capacity);
-
-		for (auto i: grd_range(old_capacity)) {
-			auto e = old_data[i];
-			if (e.is_occupied()) {
-				grd_put_entry(map, e.key)->value = e.value;
-			}
-		}
+	return storage;
+}
 
-		GrdFree(map->allocator, old_data, map->loc);
+// Allocates storage for |map->capacity| slots and marks all of them empty.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_hash_map_alloc_storage(GrdHashMap<K, V, L>* map, bool clear = true) {
+	void* block = GrdMalloc(map->allocator, grd_hash_map_storage_size<K, V, L>(map->capacity), map->loc);
+	(GrdHashMapStorage<K, V, L>&) *map = grd_hash_map_storage_at<K, V, L>(block, map->capacity);
+	if (clear) {
+		for (auto i: grd_range(map->capacity)) {
+			grd_hash_map_slot_hash(map, i) = HASH_MAP_HASH_EMPTY;
+		}
 	}
+}
 
-	GrdHash64 hash = grd_hash_key(key);
-	s64 idx = hash % map->capacity;
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_put_slot(GrdHashMap<K, V, L>* map, K key, GrdHash64 hash);
+
+// Inserts |key| or finds its slot, never grows the map.
+// |hash| must be grd_hash_key(key).
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_insert_slot(GrdHashMap<K, V, L>* map, K key, GrdHash64 hash) {
+	s64 idx = grd_hash_map_get_home(map, hash);
 	s64 home = idx;
-	GrdHashMapEntry<K, V>* e = NULL;
 	s64 cap = map->capacity;
 
 	while (true) {
-		e = &map->data[idx];
-
-		if (e->is_occupied()) {
-			if (e->normalized_hash == hash && e->key == key) {
+		if (grd_hash_map_slot_is_occupied(map, idx)) {
+			if (grd_hash_map_slot_hash(map, idx) == hash && grd_hash_map_slot_key(map, idx) == key) {
 				break;
 			}
-			
-			s64 a_dist = grd_hash_map_distance_from_home(grd_hash_map_get_home(map, e), idx, cap);
+
+			s64 a_dist = grd_hash_map_slot_distance(map, idx);
 			s64 b_dist = grd_hash_map_distance_from_home(home, idx, cap);
 			if (a_dist < b_dist) {
 				map->count += 1;
-				// GrdFree the entry by shifting it's value to the right.
+				// Free the slot by shifting it's entry to the right.
+				// Slot |idx| holds the entry that is being carried.
 				s64 sh_idx = grd_hash_map_next_index_wraparound(idx, map->capacity);
 				while (true) {
-					auto sh_e = &map->data[sh_idx];
-					if (!sh_e->is_occupied()) {
-						*sh_e = *e;
+					if (!grd_hash_map_slot_is_occupied(map, sh_idx)) {
+						grd_hash_map_copy_slot(map, sh_idx, idx);
 						break;
 					}
 
-					s64 c_dist = grd_hash_map_distance_from_home(grd_hash_map_get_home(map, sh_e), sh_idx, cap);
-					s64 d_dist = grd_hash_map_distance_from_home(grd_hash_map_get_home(map, e), sh_idx, cap);
+					s64 c_dist = grd_hash_map_slot_distance(map, sh_idx);
+					s64 d_dist = grd_hash_map_distance_from_home(grd_hash_map_get_home(map, grd_hash_map_slot_hash(map, idx)), sh_idx, cap);
 					if (c_dist < d_dist) {
-						auto tmp = *sh_e;
-						*sh_e = *e;
-						*e = tmp;
+						grd_hash_map_swap_slots(map, sh_idx, idx);
 					}
 					sh_idx = grd_hash_map_next_index_wraparound(sh_idx, map->capacity);
 				}
@@ -158,151 +373,503 @@ GRD_DEDUP GrdHashMapEntry<K, V>* grd_put_entry(GrdHashMap<K, V>* map, K key) {
 		}
 		idx = grd_hash_map_next_index_wraparound(idx, map->capacity);
 	}
-	e->key = key;
-	e->normalized_hash = hash;
-	return e;
+	grd_hash_map_slot_key(map, idx) = key;
+	grd_hash_map_slot_hash(map, idx) = hash;
+	return idx;
 }
 
-template <typename K, typename V>
-GRD_DEDUP GrdHashMapEntry<K, V>* grd_get_entry(GrdHashMap<K, V>* map, std::type_identity_t<K> key) {
-	if (!map->data) {
-		return NULL;
+// Empties slot |idx| and shifts following entries back.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_hash_map_erase_slot(GrdHashMap<K, V, L>* map, s64 idx) {
+	grd_hash_map_slot_hash(map, idx) = HASH_MAP_HASH_EMPTY;
+
+	// Backward shift.
+	s64 prev_idx = idx;
+	s64 shift_idx = grd_hash_map_next_index_wraparound(idx, map->capacity);
+	while (true) {
+		if (!grd_hash_map_slot_is_occupied(map, shift_idx)) {
+			break;
+		}
+		s64 shift_home = grd_hash_map_get_home(map, grd_hash_map_slot_hash(map, shift_idx));
+		if (shift_home == shift_idx) {
+			break;
+		}
+		assert(
+			grd_hash_map_distance_from_home(shift_home, shift_idx, map->capacity) >
+			grd_hash_map_distance_from_home(shift_home, prev_idx, map->capacity));
+
+		grd_hash_map_copy_slot(map, prev_idx, shift_idx);
+		prev_idx = shift_idx;
+		grd_hash_map_slot_hash(map, shift_idx) = HASH_MAP_HASH_EMPTY;
+		shift_idx = grd_hash_map_next_index_wraparound(shift_idx, map->capacity);
 	}
-	GrdHash64 hash = grd_hash_key(key);
-	s64 idx = hash % map->capacity;
+
+	map->count -= 1;
+}
+
+// Moves all entries into new storage of |new_capacity| slots.
+// Must not be called during incremental rehash.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_hash_map_rehash(GrdHashMap<K, V, L>* map, s64 new_capacity) {
+	assert(map->old_capacity == 0);
+	if (map->next_storage.block()) {
+		GrdFree(map->allocator, map->next_storage.block(), map->loc);
+		map->next_storage = {};
+		map->next_cleared = 0;
+	}
+	auto old_map = *map;
+
+	map->capacity = new_capacity;
+	grd_hash_map_alloc_storage(map);
+	map->count = 0;
+
+	if (old_map.storage_block()) {
+		for (auto i: grd_range(old_map.capacity)) {
+			if (grd_hash_map_slot_is_occupied(&old_map, i)) {
+				s64 idx = grd_hash_map_insert_slot(map, grd_hash_map_slot_key(&old_map, i), grd_hash_map_slot_hash(&old_map, i));
+				grd_hash_map_slot_value(map, idx) = grd_hash_map_slot_value(&old_map, i);
+			}
+		}
+		GrdFree(map->allocator, old_map.storage_block(), map->loc);
+	}
+}
+
+// How many old table slots every put/remove visits during incremental rehash.
+// New table is twice as big, so migration is over long before it fills up.
+GRD_DEDUP constexpr s64 GRD_HASH_MAP_MIGRATE_STEP = 16;
+// How many slots of the next table every put clears.
+// Next table has 2 * capacity slots and is allocated at half of the load,
+//   so it needs ~5.3 slots per put to be ready in time.
+GRD_DEDUP constexpr s64 GRD_HASH_MAP_CLEAR_STEP = 64;
+
+// Moves entries of up to |steps| old table slots into the new table.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_hash_map_migrate(GrdHashMap<K, V, L>* map, s64 steps) {
+	if (!grd_hash_map_is_migrating(map)) {
+		return;
+	}
+	auto old = grd_hash_map_old_table(map);
+	while (steps > 0 && map->old_count > 0) {
+		s64 idx = map->migrate_idx;
+		if (grd_hash_map_slot_is_occupied(&old, idx)) {
+			K         key   = grd_hash_map_slot_key(&old, idx);
+			V         value = grd_hash_map_slot_value(&old, idx);
+			GrdHash64 hash  = grd_hash_map_slot_hash(&old, idx);
+			// Erasing shifts the next entries into |idx|, so it's visited again.
+			// Slots before |migrate_idx| stay empty, so shifts never wrap into them.
+			grd_hash_map_erase_slot(&old, idx);
+			map->old_count -= 1;
+			map->count -= 1;
+			s64 new_idx = grd_hash_map_insert_slot(map, key, hash);
+			grd_hash_map_slot_value(map, new_idx) = value;
+		} else {
+			map->migrate_idx += 1;
+		}
+		steps -= 1;
+	}
+	if (map->old_count == 0) {
+		GrdFree(map->allocator, map->old_storage.block(), map->loc);
+		map->old_storage  = {};
+		map->old_capacity = 0;
+		map->migrate_idx  = 0;
+	}
+}
+
+// Allocates the next table once the map is half full and clears up to |steps| of its slots.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_hash_map_prepare_next_table(GrdHashMap<K, V, L>* map, s64 steps) {
+	if (grd_hash_map_is_migrating(map) || map->count < map->capacity * map->load_factor / 2) {
+		return;
+	}
+	auto next = grd_hash_map_table_view(map, map->next_storage, map->capacity * 2, 0);
+	if (!map->next_storage.block()) {
+		grd_hash_map_alloc_storage(&next, false);
+		map->next_storage = next;
+		map->next_cleared = 0;
+	}
+	s64 end = map->next_cleared + grd_min(steps, next.capacity - map->next_cleared);
+	for (s64 i = map->next_cleared; i < end; i++) {
+		grd_hash_map_slot_hash(&next, i) = HASH_MAP_HASH_EMPTY;
+	}
+	map->next_cleared = end;
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_hash_map_finish_migration(GrdHashMap<K, V, L>* map) {
+	grd_hash_map_migrate(map, s64_max);
+}
+
+// Swaps in a table twice as big, entries are moved by grd_hash_map_migrate() later.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_hash_map_start_migration(GrdHashMap<K, V, L>* map) {
+	grd_hash_map_finish_migration(map);
+	// Only does work if puts didn't keep up, e.g. after many removes.
+	grd_hash_map_prepare_next_table(map, s64_max);
+	map->old_storage  = *map;
+	map->old_capacity = map->capacity;
+	map->old_count    = map->count;
+	map->migrate_idx  = 0;
+	map->capacity *= 2;
+	(GrdHashMapStorage<K, V, L>&) *map = map->next_storage;
+	map->next_storage = {};
+	map->next_cleared = 0;
+}
+
+// Grows the map so |count| entries fit without a rehash.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_hash_map_reserve(GrdHashMap<K, V, L>* map, s64 count) {
+	grd_hash_map_finish_migration(map);
+	s64 capacity = map->capacity > 4 ? grd_next_power_of_two(map->capacity) : 16;
+	while (count >= capacity * map->load_factor) {
+		capacity *= 2;
+	}
+	if (!map->storage_block() || capacity != map->capacity) {
+		grd_hash_map_rehash(map, capacity);
+	}
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_get_slot(GrdHashMap<K, V, L>* map, K key, GrdHash64 hash);
+
+// |hash| must be grd_hash_key(key).
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_put_slot(GrdHashMap<K, V, L>* map, K key, GrdHash64 hash) {
+	if (!map->storage_block()) {
+		if (map->capacity <= 4) {
+			map->capacity = 16;
+		}
+		map->capacity = grd_next_power_of_two(map->capacity);
+		grd_hash_map_alloc_storage(map);
+		map->count = 0;
+	}
+
+	if (map->incremental_rehash) {
+		grd_hash_map_migrate(map, GRD_HASH_MAP_MIGRATE_STEP);
+		grd_hash_map_prepare_next_table(map, GRD_HASH_MAP_CLEAR_STEP);
+	}
+	if (grd_hash_map_is_migrating(map)) {
+		// Key must not end up in both tables.
+		auto old = grd_hash_map_old_table(map);
+		s64 old_idx = grd_hash_map_get_slot(&old, key, hash);
+		if (old_idx != -1) {
+			V value = grd_hash_map_slot_value(&old, old_idx);
+			grd_hash_map_erase_slot(&old, old_idx);
+			map->old_count -= 1;
+			map->count -= 1;
+			s64 idx = grd_hash_map_insert_slot(map, key, hash);
+			grd_hash_map_slot_value(map, idx) = value;
+			return idx;
+		}
+	}
+
+	if (map->count >= map->capacity * map->load_factor) {
+		if (map->incremental_rehash) {
+			grd_hash_map_start_migration(map);
+			grd_hash_map_migrate(map, GRD_HASH_MAP_MIGRATE_STEP);
+		} else {
+			grd_hash_map_rehash(map, map->capacity * 2);
+		}
+	}
+
+	return grd_hash_map_insert_slot(map, key, hash);
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_put_slot(GrdHashMap<K, V, L>* map, K key) {
+	return grd_hash_map_put_slot(map, key, grd_hash_key(key));
+}
+
+// Returns -1 if |key| is not in the map.
+// Only looks at the current table, see grd_hash_map_get_value().
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_get_slot(GrdHashMap<K, V, L>* map, K key, GrdHash64 hash) {
+	if (!map->storage_block()) {
+		return -1;
+	}
+	s64 idx = grd_hash_map_get_home(map, hash);
 	s64 home = idx;
 
 	while (true) {
-		auto e = &map->data[idx];
-		if (e->is_occupied()) {
-			if (e->normalized_hash == hash && e->key == key) {
-				return e;
+		if (grd_hash_map_slot_is_occupied(map, idx)) {
+			if (grd_hash_map_slot_hash(map, idx) == hash && grd_hash_map_slot_key(map, idx) == key) {
+				return idx;
 			}
-			
-			s64 a_dist = grd_hash_map_distance_from_home(grd_hash_map_get_home(map, e), idx, map->capacity);
+
+			s64 a_dist = grd_hash_map_slot_distance(map, idx);
 			s64 b_dist = grd_hash_map_distance_from_home(home, idx, map->capacity);
 			if (a_dist < b_dist) {
 				// If the key was in this table,
 				//   it would have been in this slot in the worst case.
 				// But it's not in here, so we can early out.
-				return NULL;
+				return -1;
 			}
 		} else {
-			return NULL;
+			return -1;
 		}
 		idx = grd_hash_map_next_index_wraparound(idx, map->capacity);
 	}
 }
 
-template <typename K, typename V>
-GRD_DEDUP GrdHashMapEntry<K, V>* grd_remove(GrdHashMap<K, V>* map, std::type_identity_t<K> key) {
-	if (!map->data) {
-		return NULL;
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_get_slot(GrdHashMap<K, V, L>* map, K key) {
+	return grd_hash_map_get_slot(map, key, grd_hash_key(key));
+}
+
+// Returns index of the slot |key| was removed from, or -1 if |key| is not in the map.
+// Only looks at the current table, see grd_hash_map_remove_key().
+// Backward shift may move another entry into the returned slot,
+//   so the removed value is copied to |out_value| before that.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_remove_slot(GrdHashMap<K, V, L>* map, K key, GrdHash64 hash, V* out_value = NULL) {
+	if (!map->storage_block()) {
+		return -1;
 	}
-	GrdHash64 hash = grd_hash_key(key);
-	s64 idx = hash % map->capacity;
-	s64 home = idx;
+	s64 idx = grd_hash_map_get_home(map, hash);
 
 	while (true) {
-		auto e = &map->data[idx];
-		if (!e->is_occupied()) {
-			return NULL;
+		if (!grd_hash_map_slot_is_occupied(map, idx)) {
+			return -1;
 		}
-		if (e->normalized_hash == hash && e->key == key) {
-			e->normalized_hash = HASH_MAP_HASH_EMPTY;
-
-			// Backward shift.
-			s64 prev_idx = idx;
-			s64 shift_idx = grd_hash_map_next_index_wraparound(idx, map->capacity);
-			while (true) {
-				auto shift_e = &map->data[shift_idx];
-				if (!shift_e->is_occupied()) {
-					break;
-				}
-				if (grd_hash_map_get_home(map, shift_e) == shift_idx) {
-					break;
-				}
-				assert(
-					grd_hash_map_distance_from_home(grd_hash_map_get_home(map, shift_e), shift_idx, map->capacity) >
-					grd_hash_map_distance_from_home(grd_hash_map_get_home(map, shift_e), prev_idx, map->capacity));
-
-				map->data[prev_idx] = *shift_e;
-				prev_idx = shift_idx;
-				shift_e->normalized_hash = HASH_MAP_HASH_EMPTY;
-				shift_idx = grd_hash_map_next_index_wraparound(shift_idx, map->capacity);
+		if (grd_hash_map_slot_hash(map, idx) == hash && grd_hash_map_slot_key(map, idx) == key) {
+			if (out_value) {
+				*out_value = grd_hash_map_slot_value(map, idx);
 			}
-
-			map->count -= 1;
-			return e;
+			grd_hash_map_erase_slot(map, idx);
+			return idx;
 		}
 		idx = grd_hash_map_next_index_wraparound(idx, map->capacity);
 	}
 }
 
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_remove_slot(GrdHashMap<K, V, L>* map, K key) {
+	return grd_hash_map_remove_slot(map, key, grd_hash_key(key));
+}
+
+// Both grd_hash_map_get_value and grd_hash_map_remove_key
+//   also look in the table that incremental rehash is moving entries from.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP V* grd_hash_map_get_value(GrdHashMap<K, V, L>* map, K key, GrdHash64 hash) {
+	s64 idx = grd_hash_map_get_slot(map, key, hash);
+	if (idx != -1) {
+		return &grd_hash_map_slot_value(map, idx);
+	}
+	if (grd_hash_map_is_migrating(map)) {
+		auto old = grd_hash_map_old_table(map);
+		idx = grd_hash_map_get_slot(&old, key, hash);
+		if (idx != -1) {
+			return &grd_hash_map_slot_value(&old, idx);
+		}
+	}
+	return NULL;
+}
+
+// Removes |key| from the old table. Returns index of the slot it was in or -1.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_hash_map_remove_old_slot(GrdHashMap<K, V, L>* map, K key, GrdHash64 hash, V* out_value = NULL) {
+	if (!grd_hash_map_is_migrating(map)) {
+		return -1;
+	}
+	auto old = grd_hash_map_old_table(map);
+	s64 idx = grd_hash_map_remove_slot(&old, key, hash, out_value);
+	if (idx != -1) {
+		map->old_count -= 1;
+		map->count -= 1;
+	}
+	return idx;
+}
+
+// Copies removed value to |out_value| if it's not NULL.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP bool grd_hash_map_remove_key(GrdHashMap<K, V, L>* map, K key, GrdHash64 hash, V* out_value = NULL) {
+	grd_hash_map_migrate(map, GRD_HASH_MAP_MIGRATE_STEP);
+	if (grd_hash_map_remove_slot(map, key, hash, out_value) != -1) {
+		return true;
+	}
+	return grd_hash_map_remove_old_slot(map, key, hash, out_value) != -1;
+}
+
 template <typename K, typename V>
-GRD_DEDUP V* grd_put(GrdHashMap<K, V>* map, std::type_identity_t<K> key) {
-	return &grd_put_entry(map, key)->value;
+GRD_DEDUP GrdHashMapEntry<K, V>* grd_put_entry(GrdHashMap<K, V>* map, std::type_identity_t<K> key) {
+	return &map->data[grd_hash_map_put_slot(map, key)];
 }
 
 template <typename K, typename V>
-GRD_DEDUP V* grd_put(GrdHashMap<K, V>* map, std::type_identity_t<K> key, std::type_identity_t<V> value) {
+GRD_DEDUP GrdHashMapEntry<K, V>* grd_get_entry(GrdHashMap<K, V>* map, std::type_identity_t<K> key) {
+	GrdHash64 hash = grd_hash_key(key);
+	s64 idx = grd_hash_map_get_slot(map, key, hash);
+	if (idx != -1) {
+		return &map->data[idx];
+	}
+	if (grd_hash_map_is_migrating(map)) {
+		auto old = grd_hash_map_old_table(map);
+		idx = grd_hash_map_get_slot(&old, key, hash);
+		if (idx != -1) {
+			return &map->old_storage.data[idx];
+		}
+	}
+	return NULL;
+}
+
+// Returns true if |key| was in the map, its value is copied to |out_value|.
+// Backward shift reuses the slot right away, so there's no entry to return.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP bool grd_remove(GrdHashMap<K, V, L>* map, std::type_identity_t<K> key, V* out_value = NULL) {
+	return grd_hash_map_remove_key(map, key, grd_hash_key(key), out_value);
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP V* grd_put(GrdHashMap<K, V, L>* map, std::type_identity_t<K> key) {
+	return &grd_hash_map_slot_value(map, grd_hash_map_put_slot(map, key));
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP V* grd_put(GrdHashMap<K, V, L>* map, std::type_identity_t<K> key, std::type_identity_t<V> value) {
 	V* result = grd_put(map, key);
 	*result = value;
 	return result;
 }
 
-template <typename K, typename V>
-GRD_DEDUP V* grd_get(GrdHashMap<K, V>* map, std::type_identity_t<K> key) {
-	auto* e = grd_get_entry(map, key);
-	if (!e) {
-		return NULL;
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP V* grd_get(GrdHashMap<K, V, L>* map, std::type_identity_t<K> key) {
+	return grd_hash_map_get_value(map, key, grd_hash_key(key));
+}
+
+// How many keys grd_get_many/grd_put_many hash and prefetch before probing.
+// Big enough to keep plenty of cache misses in flight,
+//   small enough for prefetched lines to survive until they're probed.
+GRD_DEDUP constexpr s64 GRD_HASH_MAP_BATCH_SIZE = 16;
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_hash_map_prefetch_home(GrdHashMap<K, V, L>* map, GrdHash64 hash) {
+	s64 home = grd_hash_map_get_home(map, hash);
+	if constexpr (L == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+		GrdPrefetch(&map->data[home]);
+	} else {
+		GrdPrefetch(&map->hashes[home]);
+		GrdPrefetch(&map->keys[home]);
 	}
-	return &e->value;
 }
 
-template <typename K, typename V>
-GRD_DEDUP s64 grd_len(GrdHashMap<K, V> map) {
+// Looks up all |keys| at once, |out_values[i]| is set to grd_get(map, keys[i]).
+// Faster than calling grd_get in a loop on maps that don't fit in the cache,
+//   because memory loads of a whole batch are overlapped.
+// Returns how many keys were found.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_get_many(GrdHashMap<K, V, L>* map, std::type_identity_t<GrdSpan<K>> keys, std::type_identity_t<GrdSpan<V*>> out_values) {
+	assert(out_values.count >= keys.count);
+	if (!map->storage_block()) {
+		for (auto i: grd_range(keys.count)) {
+			out_values[i] = NULL;
+		}
+		return 0;
+	}
+	s64 found = 0;
+	GrdHash64 hashes[GRD_HASH_MAP_BATCH_SIZE];
+	for (s64 start = 0; start < keys.count; start += GRD_HASH_MAP_BATCH_SIZE) {
+		s64 batch = grd_min(keys.count - start, GRD_HASH_MAP_BATCH_SIZE);
+		for (auto i: grd_range(batch)) {
+			hashes[i] = grd_hash_key(keys.data[start + i]);
+			grd_hash_map_prefetch_home(map, hashes[i]);
+		}
+		for (auto i: grd_range(batch)) {
+			V* value = grd_hash_map_get_value(map, keys.data[start + i], hashes[i]);
+			out_values.data[start + i] = value;
+			if (value) {
+				found += 1;
+			}
+		}
+	}
+	return found;
+}
+
+// Same as calling grd_put(map, keys[i], values[i]) for every key,
+//   but grows the map once up front and prefetches home slots of a batch
+//   before inserting it.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_put_many(GrdHashMap<K, V, L>* map, std::type_identity_t<GrdSpan<K>> keys, std::type_identity_t<GrdSpan<V>> values) {
+	assert(values.count >= keys.count);
+	// Prefetched slots must stay where they are for the whole batch.
+	grd_hash_map_reserve(map, map->count + keys.count);
+	GrdHash64 hashes[GRD_HASH_MAP_BATCH_SIZE];
+	for (s64 start = 0; start < keys.count; start += GRD_HASH_MAP_BATCH_SIZE) {
+		s64 batch = grd_min(keys.count - start, GRD_HASH_MAP_BATCH_SIZE);
+		for (auto i: grd_range(batch)) {
+			hashes[i] = grd_hash_key(keys.data[start + i]);
+			grd_hash_map_prefetch_home(map, hashes[i]);
+		}
+		for (auto i: grd_range(batch)) {
+			s64 idx = grd_hash_map_put_slot(map, keys.data[start + i], hashes[i]);
+			grd_hash_map_slot_value(map, idx) = values.data[start + i];
+		}
+	}
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_len(GrdHashMap<K, V, L> map) {
 	return map.count;
 }
 
+// GRD_HASH_MAP_LAYOUT_ENTRIES: *_offset are offsets inside of an entry,
+//   entries are |entry_size| bytes apart.
+// GRD_HASH_MAP_LAYOUT_SPLIT: *_offset are offsets of hashes/keys/values
+//   array pointers inside of the map, items are |key_size|, |value_size|
+//   and sizeof(GrdHash64) bytes apart, |entry_size| is 0.
 struct GrdHashMapType: GrdMapType {
+	GrdHashMapLayout layout = GRD_HASH_MAP_LAYOUT_ENTRIES;
 	s32 key_offset   = 0;
 	s32 value_offset = 0;
 	s32 hash_offset  = 0;
 	u32 entry_size   = 0;
+	u32 key_size     = 0;
+	u32 value_size   = 0;
 
 	struct Item: GrdMapType::Item {
 		GrdHash64* hash;
 	};
 };
 
-template <typename K, typename V>
-GRD_DEDUP GrdHashMapType* grd_reflect_create_type(GrdHashMap<K, V>* x) {
-	return grd_reflect_register_type<GrdHashMap<K, V>, GrdHashMapType>("");
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP GrdHashMapType* grd_reflect_create_type(GrdHashMap<K, V, L>* x) {
+	return grd_reflect_register_type<GrdHashMap<K, V, L>, GrdHashMapType>("");
 }
 
-template <typename K, typename V>
-GRD_DEDUP void grd_reflect_type(GrdHashMap<K, V>* x, GrdHashMapType* type) {
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP void grd_reflect_type(GrdHashMap<K, V, L>* x, GrdHashMapType* type) {
 	type->key   = grd_reflect_type_of<K>();
 	type->value = grd_reflect_type_of<V>();
-	type->name  = grd_heap_sprintf("GrdHashMap<%s, %s>", type->key->name, type->value->name);
+	if constexpr (L == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+		type->name = grd_heap_sprintf("GrdHashMap<%s, %s>", type->key->name, type->value->name);
+	} else {
+		type->name = grd_heap_sprintf("GrdHashMap<%s, %s, GRD_HASH_MAP_LAYOUT_SPLIT>", type->key->name, type->value->name);
+	}
 	type->subkind = "hash_map";
 
-	using Map = GrdHashMap<K, V>;
+	using Map = GrdHashMap<K, V, L>;
 	using Entry = Map::Entry;
 
-	type->key_offset   = offsetof(Entry, key);
-	type->value_offset = offsetof(Entry, value);
-	type->hash_offset  = offsetof(Entry, normalized_hash);
-	type->entry_size   = sizeof(Entry);
+	type->layout     = L;
+	type->key_size   = sizeof(K);
+	type->value_size = sizeof(V);
+	if constexpr (L == GRD_HASH_MAP_LAYOUT_ENTRIES) {
+		type->key_offset   = offsetof(Entry, key);
+		type->value_offset = offsetof(Entry, value);
+		type->hash_offset  = offsetof(Entry, normalized_hash);
+		type->entry_size   = sizeof(Entry);
+	} else {
+		type->key_offset   = GRD_OFFSETOF(Map, keys);
+		type->value_offset = GRD_OFFSETOF(Map, values);
+		type->hash_offset  = GRD_OFFSETOF(Map, hashes);
+		type->entry_size   = 0;
+	}
 
 	type->get_count = [](void* map) {
-		auto casted = (GrdHashMap<int, int>*) map;
+		auto casted = (Map*) map;
 		return grd_len(*casted);
 	};
 
 	type->get_capacity = [](void* map) {
-		auto casted = (GrdHashMap<int, int>*) map;
+		auto casted = (Map*) map;
 		return casted->capacity;
 	};
 
@@ -312,11 +879,19 @@ GRD_DEDUP void grd_reflect_type(GrdHashMap<K, V>* x, GrdHashMapType* type) {
 		GrdHashMapType::Item item;
 
 		for (auto i: grd_range(casted_map->capacity)) {
-			auto* entry = (Entry*) grd_ptr_add(casted_map->data, i * sizeof(Entry));
-			if (entry->is_occupied()) {
-				item.key   = &entry->key;
-				item.value = &entry->value;
-				item.hash  = &entry->normalized_hash;
+			if (grd_hash_map_slot_is_occupied(casted_map, i)) {
+				item.key   = &grd_hash_map_slot_key(casted_map, i);
+				item.value = &grd_hash_map_slot_value(casted_map, i);
+				item.hash  = &grd_hash_map_slot_hash(casted_map, i);
+				co_yield &item;
+			}
+		}
+		auto old = grd_hash_map_old_table(casted_map);
+		for (auto i: grd_range(old.capacity)) {
+			if (grd_hash_map_slot_is_occupied(&old, i)) {
+				item.key   = &grd_hash_map_slot_key(&old, i);
+				item.value = &grd_hash_map_slot_value(&old, i);
+				item.hash  = &grd_hash_map_slot_hash(&old, i);
 				co_yield &item;
 			}
 		}
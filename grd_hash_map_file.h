@@ -0,0 +1,177 @@
+#pragma once
+
+#include "grd_hash_map.h"
+#include "grd_file.h"
+
+// On-disk GrdHashMap that is used straight from a read-only mapping.
+// File is a header followed by the storage block of the map as is.
+// Storage has no pointers (see grd_hash_map_storage_at()),
+//   so opening a file is just mmap and a few checks,
+//   and the pages are shared between processes through the page cache.
+//
+// Keys and values must be trivially copyable and must not point anywhere.
+// Slots are found with grd_hash_key(), so files are only readable
+//   by builds where it gives the same hashes.
+
+// "GRDHMAP1"
+GRD_DEDUP constexpr u64 GRD_HASH_MAP_FILE_MAGIC = 0x3150'414d'4844'5247;
+// Bump when the format or grd_hash_key() changes.
+GRD_DEDUP constexpr u32 GRD_HASH_MAP_FILE_VERSION = 1;
+// Storage block offset in the file is aligned to this.
+GRD_DEDUP constexpr u64 GRD_HASH_MAP_FILE_ALIGNMENT = 64;
+
+struct GrdHashMapFileHeader {
+	u64 magic;
+	u32 version;
+	s32 layout;
+	u32 key_size;
+	u32 value_size;
+	s64 capacity;
+	s64 count;
+	u64 storage_offset;
+	u64 storage_size;
+};
+
+// Map over a mapped file. |map| must not be modified.
+template <typename K, typename V, GrdHashMapLayout L = GRD_HASH_MAP_LAYOUT_ENTRIES>
+struct GrdMappedHashMap {
+	GrdMappedFile       file;
+	GrdHashMap<K, V, L> map;
+
+	void free() {
+		grd_unmap_file(&file);
+		map = {};
+	}
+};
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP GrdHashMapFileHeader grd_hash_map_file_header(s64 capacity, s64 count) {
+	GrdHashMapFileHeader header = {
+		.magic          = GRD_HASH_MAP_FILE_MAGIC,
+		.version        = GRD_HASH_MAP_FILE_VERSION,
+		.layout         = L,
+		.key_size       = sizeof(K),
+		.value_size     = sizeof(V),
+		.capacity       = capacity,
+		.count          = count,
+		.storage_offset = grd_align(sizeof(GrdHashMapFileHeader), GRD_HASH_MAP_FILE_ALIGNMENT),
+		.storage_size   = capacity > 0 ? grd_hash_map_storage_size<K, V, L>(capacity) : 0,
+	};
+	return header;
+}
+
+// Finishes incremental rehash of |map| if it's in progress.
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP GrdError* grd_write_hash_map(GrdFile* file, GrdHashMap<K, V, L>* map) {
+	static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>);
+	grd_hash_map_finish_migration(map);
+
+	s64 capacity = map->storage_block() ? map->capacity : 0;
+	auto header = grd_hash_map_file_header<K, V, L>(capacity, map->count);
+	if (auto e = grd_write_file(file, &header, sizeof(header))) {
+		return e;
+	}
+	u8 padding[GRD_HASH_MAP_FILE_ALIGNMENT] = {};
+	if (auto e = grd_write_file(file, padding, header.storage_offset - sizeof(header))) {
+		return e;
+	}
+	if (header.storage_size > 0) {
+		if (auto e = grd_write_file(file, map->storage_block(), header.storage_size)) {
+			return e;
+		}
+	}
+	return NULL;
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP GrdError* grd_write_hash_map(GrdUnicodeString path, GrdHashMap<K, V, L>* map) {
+	auto [file, e] = grd_open_file(path, GRD_FILE_WRITE | GRD_FILE_CREATE_NEW);
+	if (e) {
+		return e;
+	}
+	grd_defer_x(grd_close_file(&file));
+	return grd_write_hash_map(&file, map);
+}
+
+template <typename K, typename V, GrdHashMapLayout L = GRD_HASH_MAP_LAYOUT_ENTRIES>
+GRD_DEDUP GrdTuple<GrdMappedHashMap<K, V, L>, GrdError*> grd_map_hash_map_file(GrdFile* file) {
+	static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>);
+	GrdMappedHashMap<K, V, L> result;
+	auto [mapped, e] = grd_map_file(file);
+	if (e) {
+		return { {}, e };
+	}
+	result.file = mapped;
+
+	auto fail = [&](const char* msg) -> GrdTuple<GrdMappedHashMap<K, V, L>, GrdError*> {
+		result.free();
+		return { {}, grd_make_error(msg) };
+	};
+
+	if (mapped.size < s64(sizeof(GrdHashMapFileHeader))) {
+		return fail("File is too small for a hash map header");
+	}
+	auto header = (GrdHashMapFileHeader*) mapped.data;
+	if (header->magic != GRD_HASH_MAP_FILE_MAGIC) {
+		return fail("Not a hash map file");
+	}
+	if (header->version != GRD_HASH_MAP_FILE_VERSION) {
+		return fail("Unsupported hash map file version");
+	}
+	if (header->capacity < 0 || (header->capacity > 0 && !grd_is_power_of_two(header->capacity))) {
+		return fail("Invalid hash map capacity");
+	}
+	// Every slot stores at least its hash, a bigger capacity can't fit
+	//   and would overflow the storage size below.
+	if (u64(header->capacity) > u64(mapped.size) / sizeof(GrdHash64)) {
+		return fail("Hash map file is truncated");
+	}
+	if (header->count < 0 || header->count > header->capacity) {
+		return fail("Invalid hash map count");
+	}
+	auto expected = grd_hash_map_file_header<K, V, L>(header->capacity, header->count);
+	if (header->layout     != expected.layout ||
+		header->key_size   != expected.key_size ||
+		header->value_size != expected.value_size ||
+		header->storage_offset != expected.storage_offset ||
+		header->storage_size   != expected.storage_size)
+	{
+		return fail("Hash map file doesn't match key/value types or layout");
+	}
+	if (header->storage_offset + header->storage_size > (u64) mapped.size) {
+		return fail("Hash map file is truncated");
+	}
+
+	if (header->capacity > 0) {
+		void* block = grd_ptr_add(mapped.data, header->storage_offset);
+		(GrdHashMapStorage<K, V, L>&) result.map = grd_hash_map_storage_at<K, V, L>(block, header->capacity);
+		result.map.capacity = header->capacity;
+		result.map.count    = header->count;
+	}
+	return { result, NULL };
+}
+
+template <typename K, typename V, GrdHashMapLayout L = GRD_HASH_MAP_LAYOUT_ENTRIES>
+GRD_DEDUP GrdTuple<GrdMappedHashMap<K, V, L>, GrdError*> grd_map_hash_map_file(GrdUnicodeString path) {
+	auto [file, e] = grd_open_file(path, GRD_FILE_READ);
+	if (e) {
+		return { {}, e };
+	}
+	grd_defer_x(grd_close_file(&file));
+	return grd_map_hash_map_file<K, V, L>(&file);
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP V* grd_get(GrdMappedHashMap<K, V, L>* mapped, std::type_identity_t<K> key) {
+	return grd_get(&mapped->map, key);
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP bool grd_contains(GrdMappedHashMap<K, V, L>* mapped, std::type_identity_t<K> key) {
+	return grd_get(&mapped->map, key) != NULL;
+}
+
+template <typename K, typename V, GrdHashMapLayout L>
+GRD_DEDUP s64 grd_len(GrdMappedHashMap<K, V, L>& mapped) {
+	return mapped.map.count;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "grd_hash_map.h"
+#include "grd_type_utils.h"
+
+// GrdHashMap without values.
+// GrdHashMapEntry<K, GrdEmptyStruct> has no space for the value,
+//   so an entry is just the key and its hash.
+template <typename K>
+struct GrdHashSet: GrdHashMap<K, GrdEmptyStruct> {
+	using Map = GrdHashMap<K, GrdEmptyStruct>;
+
+	GrdGenerator<K*> iterate() {
+		auto xxx = this; // See GrdHashMap::iterate().
+		for (auto e: xxx->Map::iterate()) {
+			co_yield &e->key;
+		}
+	}
+};
+
+// Returns true if |key| wasn't in the set.
+template <typename K>
+GRD_DEDUP bool grd_add(GrdHashSet<K>* set, std::type_identity_t<K> key) {
+	s64 count_before = set->count;
+	grd_hash_map_put_slot(set, key);
+	return set->count != count_before;
+}
+
+template <typename K>
+GRD_DEDUP bool grd_contains(GrdHashSet<K>* set, std::type_identity_t<K> key) {
+	return grd_hash_map_get_value(set, key, grd_hash_key(key)) != NULL;
+}
+
+// Returns true if |key| was in the set.
+template <typename K>
+GRD_DEDUP bool grd_remove(GrdHashSet<K>* set, std::type_identity_t<K> key) {
+	return grd_hash_map_remove_key(set, key, grd_hash_key(key));
+}
+
+// Adds all keys of |src| to |dst|.
+template <typename K>
+GRD_DEDUP void grd_add(GrdHashSet<K>* dst, GrdHashSet<K>* src) {
+	if (!dst->incremental_rehash) {
+		grd_hash_map_reserve(dst, dst->count + src->count);
+	}
+	for (K* key: src->iterate()) {
+		grd_add(dst, *key);
+	}
+}
+
+template <typename K>
+GRD_DEDUP GrdHashSet<K> grd_union(GrdAllocator allocator, GrdHashSet<K>* a, GrdHashSet<K>* b, GrdCodeLoc loc = grd_caller_loc()) {
+	GrdHashSet<K> result;
+	result.allocator = allocator;
+	result.loc = loc;
+	grd_add(&result, a);
+	grd_add(&result, b);
+	return result;
+}
+
+template <typename K>
+GRD_DEDUP GrdHashSet<K> grd_union(GrdHashSet<K>* a, GrdHashSet<K>* b, GrdCodeLoc loc = grd_caller_loc()) {
+	return grd_union(c_allocator, a, b, loc);
+}
+
+template <typename K>
+GRD_DEDUP GrdHashSet<K> grd_intersection(GrdAllocator allocator, GrdHashSet<K>* a, GrdHashSet<K>* b, GrdCodeLoc loc = grd_caller_loc()) {
+	GrdHashSet<K> result;
+	result.allocator = allocator;
+	result.loc = loc;
+	// Probe the bigger set with keys of the smaller one.
+	if (a->count > b->count) {
+		grd_swap(&a, &b);
+	}
+	for (K* key: a->iterate()) {
+		if (grd_contains(b, *key)) {
+			grd_add(&result, *key);
+		}
+	}
+	return result;
+}
+
+template <typename K>
+GRD_DEDUP GrdHashSet<K> grd_intersection(GrdHashSet<K>* a, GrdHashSet<K>* b, GrdCodeLoc loc = grd_caller_loc()) {
+	return grd_intersection(c_allocator, a, b, loc);
+}
+
+// Keys of |a| that are not in |b|.
+template <typename K>
+GRD_DEDUP GrdHashSet<K> grd_difference(GrdAllocator allocator, GrdHashSet<K>* a, GrdHashSet<K>* b, GrdCodeLoc loc = grd_caller_loc()) {
+	GrdHashSet<K> result;
+	result.allocator = allocator;
+	result.loc = loc;
+	for (K* key: a->iterate()) {
+		if (!grd_contains(b, *key)) {
+			grd_add(&result, *key);
+		}
+	}
+	return result;
+}
+
+template <typename K>
+GRD_DEDUP GrdHashSet<K> grd_difference(GrdHashSet<K>* a, GrdHashSet<K>* b, GrdCodeLoc loc = grd_caller_loc()) {
+	return grd_difference(c_allocator, a, b, loc);
+}
+
+template <typename K>
+GRD_DEDUP GrdSetType* grd_reflect_create_type(GrdHashSet<K>* x) {
+	return grd_reflect_register_type<GrdHashSet<K>, GrdSetType>("");
+}
+
+template <typename K>
+GRD_DEDUP void grd_reflect_type(GrdHashSet<K>* x, GrdSetType* type) {
+	type->inner = grd_reflect_type_of<K>();
+	type->name = grd_heap_sprintf("GrdHashSet<%s>", type->inner->name);
+	type->subkind = "hash_set";
+
+	type->get_count = [](void* set) {
+		return grd_len(*(GrdHashSet<K>*) set);
+	};
+
+	type->iterate = [](void* set) -> GrdGenerator<void*> {
+		auto casted = (GrdHashSet<K>*) set;
+		for (K* key: casted->iterate()) {
+			co_yield key;
+		}
+	};
+}
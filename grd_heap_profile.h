@@ -0,0 +1,287 @@
+#pragma once
+
+#include "grd_tracker_allocator.h"
+#include "grd_stack_trace.h"
+#include "grd_hash_map.h"
+#include "grd_string.h"
+#include "grd_file.h"
+
+// Heap profiles from call stacks of a GrdTrackerAllocator made with
+//   |stack_depth| > 0. Profiles of a sampling tracker hold estimates.
+// Frames are symbolized with grd_stack_address_info(), frames without
+//   a symbol are written as addresses.
+
+enum class GrdHeapProfileKind {
+	// Memory allocated and not freed yet.
+	Live,
+	// Everything allocated since the tracker was made.
+	Allocated,
+};
+
+struct GrdHeapProfileSymbols {
+	GrdAllocator                                arena;
+	GrdHashMap<void*, GrdStackAddressInfo>      infos;
+};
+
+GRD_DEDUP GrdHeapProfileSymbols grd_make_heap_profile_symbols(GrdAllocator allocator) {
+	GrdHeapProfileSymbols symbols;
+	symbols.arena = grd_make_arena_allocator(allocator, 64 * 1024);
+	symbols.infos.allocator = allocator;
+	return symbols;
+}
+
+GRD_DEDUP void grd_free_heap_profile_symbols(GrdHeapProfileSymbols* symbols) {
+	symbols->infos.free();
+	grd_free_allocator(symbols->arena);
+}
+
+// |frame| is a return address, the call is one byte before it.
+GRD_DEDUP GrdStackAddressInfo* grd_heap_profile_symbol(GrdHeapProfileSymbols* symbols, void* frame) {
+	if (auto info = grd_get(&symbols->infos, frame)) {
+		return info;
+	}
+	return grd_put(&symbols->infos, frame, grd_stack_address_info((u8*) frame - 1, symbols->arena));
+}
+
+GRD_DEDUP GrdArray<GrdTrackerStack*> grd_heap_profile_stacks(GrdTrackerAllocator* ta, GrdAllocator allocator) {
+	GrdArray<GrdTrackerStack*> stacks = { .allocator = allocator };
+	grd_for_each(&ta->stacks, [&](GrdHash64* hash, GrdTrackerStack** stack) {
+		grd_add(&stacks, *stack);
+	});
+	return stacks;
+}
+
+// One line per stack: frames from outermost to innermost separated by ';',
+//   then a space and bytes. Read by flamegraph.pl, speedscope, inferno.
+GRD_DEDUP GrdAllocatedString grd_heap_profile_collapsed(GrdAllocator tracker, GrdHeapProfileKind kind, GrdAllocator allocator = c_allocator) {
+	GrdAllocatedString result = { .allocator = allocator };
+	auto ta = grd_get_tracker_allocator(tracker);
+	if (!ta) {
+		return result;
+	}
+	auto symbols = grd_make_heap_profile_symbols(allocator);
+	grd_defer_x(grd_free_heap_profile_symbols(&symbols));
+	auto stacks = grd_heap_profile_stacks(ta, allocator);
+	grd_defer_x(stacks.free());
+
+	char  buf_data[32];
+	char* buf = buf_data;
+	for (auto stack: stacks) {
+		s64 bytes = kind == GrdHeapProfileKind::Live ? stack->live_bytes : stack->allocated_bytes;
+		if (bytes <= 0) {
+			continue;
+		}
+		for (s64 i = stack->frames_count - 1; i >= 0; i--) {
+			auto info = grd_heap_profile_symbol(&symbols, stack->frames[i]);
+			if (info->func) {
+				s64 start = grd_len(result);
+				grd_append(&result, info->func);
+				// ';' separates frames.
+				for (auto j: grd_range_from_to(start, grd_len(result))) {
+					if (result[j] == ';') {
+						result[j] = ':';
+					}
+				}
+			} else {
+				snprintf(buf, sizeof(buf_data), "%p", stack->frames[i]);
+				grd_append(&result, buf);
+			}
+			grd_append(&result, i > 0 ? ";" : " ");
+		}
+		if (stack->frames_count == 0) {
+			grd_append(&result, "[unknown] ");
+		}
+		snprintf(buf, sizeof(buf_data), "%lld\n", (long long) bytes);
+		grd_append(&result, buf);
+	}
+	return result;
+}
+
+// Protobuf encoding, just what profile.proto needs.
+GRD_DEDUP void grd_proto_varint(GrdArray<u8>* out, u64 x) {
+	while (x >= 0x80) {
+		grd_add(out, u8(x | 0x80));
+		x >>= 7;
+	}
+	grd_add(out, u8(x));
+}
+
+GRD_DEDUP void grd_proto_uint(GrdArray<u8>* out, u32 field, u64 x) {
+	grd_proto_varint(out, field << 3);
+	grd_proto_varint(out, x);
+}
+
+GRD_DEDUP void grd_proto_bytes(GrdArray<u8>* out, u32 field, void* data, u64 size) {
+	grd_proto_varint(out, (field << 3) | 2);
+	grd_proto_varint(out, size);
+	grd_add(out, (u8*) data, size);
+}
+
+// Writes |msg| as a field and clears it for reuse.
+GRD_DEDUP void grd_proto_message(GrdArray<u8>* out, u32 field, GrdArray<u8>* msg) {
+	grd_proto_bytes(out, field, msg->data, grd_len(*msg));
+	msg->count = 0;
+}
+
+struct GrdPprofStrings {
+	GrdArray<u8>*         out;
+	GrdHashMap<GrdString, s64> ids;
+	s64                   count = 0;
+};
+
+// String table is written as it grows, index 0 is the empty string.
+GRD_DEDUP s64 grd_pprof_string(GrdPprofStrings* strings, GrdString str) {
+	if (auto id = grd_get(&strings->ids, str)) {
+		return *id;
+	}
+	grd_proto_bytes(strings->out, 6, str.data, grd_len(str));
+	grd_put(&strings->ids, str, strings->count);
+	return strings->count++;
+}
+
+GRD_DEDUP s64 grd_pprof_string(GrdPprofStrings* strings, const char* str) {
+	return grd_pprof_string(strings, grd_make_string(str));
+}
+
+// pprof profile.proto, not compressed, pprof reads it as is.
+// Sample values are alloc_objects, alloc_space, inuse_objects and inuse_space,
+//   like in Go heap profiles, inuse_space is the default.
+GRD_DEDUP GrdArray<u8> grd_heap_profile_pprof(GrdAllocator tracker, GrdAllocator allocator = c_allocator) {
+	GrdArray<u8> out = { .allocator = allocator };
+	auto ta = grd_get_tracker_allocator(tracker);
+	if (!ta) {
+		return out;
+	}
+	auto symbols = grd_make_heap_profile_symbols(allocator);
+	grd_defer_x(grd_free_heap_profile_symbols(&symbols));
+	auto stacks = grd_heap_profile_stacks(ta, allocator);
+	grd_defer_x(stacks.free());
+
+	GrdPprofStrings strings = { .out = &out };
+	strings.ids.allocator = allocator;
+	grd_defer_x(strings.ids.free());
+	GrdArray<u8> msg = { .allocator = allocator };
+	grd_defer_x(msg.free());
+	GrdArray<u8> inner = { .allocator = allocator };
+	grd_defer_x(inner.free());
+
+	grd_pprof_string(&strings, "");
+	const char* sample_types[][2] = {
+		{ "alloc_objects", "count" },
+		{ "alloc_space",   "bytes" },
+		{ "inuse_objects", "count" },
+		{ "inuse_space",   "bytes" },
+	};
+	for (auto it: sample_types) {
+		grd_proto_uint(&msg, 1, grd_pprof_string(&strings, it[0]));
+		grd_proto_uint(&msg, 2, grd_pprof_string(&strings, it[1]));
+		grd_proto_message(&out, 1, &msg);
+	}
+
+	// Ids are 1-based, 0 means none.
+	GrdHashMap<void*, s64>       location_ids = { .allocator = allocator };
+	GrdHashMap<GrdString, s64>   function_ids = { .allocator = allocator };
+	GrdHashMap<void*, s64>       mapping_ids = { .allocator = allocator };
+	GrdArray<GrdTuple<void*, u64>> mappings = { .allocator = allocator };
+	grd_defer_x(location_ids.free());
+	grd_defer_x(function_ids.free());
+	grd_defer_x(mapping_ids.free());
+	grd_defer_x(mappings.free());
+
+	for (auto stack: stacks) {
+		for (auto frame: GrdSpan<void*>{ stack->frames, stack->frames_count }) {
+			if (grd_get(&location_ids, frame)) {
+				continue;
+			}
+			s64 location_id = grd_len(location_ids) + 1;
+			grd_put(&location_ids, frame, location_id);
+			auto info = grd_heap_profile_symbol(&symbols, frame);
+
+			s64 mapping_id = 0;
+			if (info->obj) {
+				if (auto id = grd_get(&mapping_ids, info->obj_base)) {
+					mapping_id = *id;
+				} else {
+					mapping_id = grd_len(mappings) + 1;
+					grd_put(&mapping_ids, info->obj_base, mapping_id);
+					grd_add(&mappings, { info->obj_base, u64(grd_pprof_string(&strings, info->obj)) });
+				}
+			}
+			s64 function_id = 0;
+			if (info->func) {
+				GrdString name = grd_make_string(info->func);
+				if (auto id = grd_get(&function_ids, name)) {
+					function_id = *id;
+				} else {
+					function_id = grd_len(function_ids) + 1;
+					grd_put(&function_ids, name, function_id);
+					s64 name_id = grd_pprof_string(&strings, name);
+					grd_proto_uint(&msg, 1, function_id);
+					grd_proto_uint(&msg, 2, name_id);
+					grd_proto_uint(&msg, 3, name_id);
+					grd_proto_message(&out, 5, &msg);
+				}
+			}
+
+			grd_proto_uint(&msg, 1, location_id);
+			if (mapping_id) {
+				grd_proto_uint(&msg, 2, mapping_id);
+			}
+			grd_proto_uint(&msg, 3, u64(frame) - 1);
+			if (function_id) {
+				grd_proto_uint(&inner, 1, function_id);
+				grd_proto_message(&msg, 4, &inner);
+			}
+			grd_proto_message(&out, 4, &msg);
+		}
+
+		// Leaf first, as are the frames.
+		for (auto frame: GrdSpan<void*>{ stack->frames, stack->frames_count }) {
+			grd_proto_varint(&inner, *grd_get(&location_ids, frame));
+		}
+		grd_proto_message(&msg, 1, &inner);
+		s64 values[] = { stack->allocated_count, stack->allocated_bytes, stack->live_count, stack->live_bytes };
+		for (auto it: values) {
+			grd_proto_varint(&inner, u64(it));
+		}
+		grd_proto_message(&msg, 2, &inner);
+		grd_proto_message(&out, 2, &msg);
+	}
+
+	// Limit of a mapping isn't known, it ends after the last address seen in it.
+	for (auto i: grd_range(grd_len(mappings))) {
+		auto [base, filename_id] = mappings[i];
+		u64 limit = u64(base) + 1;
+		for (auto e: location_ids.iterate()) {
+			auto info = grd_heap_profile_symbol(&symbols, e->key);
+			if (info->obj && info->obj_base == base) {
+				limit = grd_max(limit, u64(e->key) + 1);
+			}
+		}
+		grd_proto_uint(&msg, 1, i + 1);
+		grd_proto_uint(&msg, 2, u64(base));
+		grd_proto_uint(&msg, 3, limit);
+		grd_proto_uint(&msg, 5, filename_id);
+		grd_proto_uint(&msg, 7, grd_len(function_ids) > 0);
+		grd_proto_message(&out, 3, &msg);
+	}
+
+	grd_proto_uint(&msg, 1, grd_pprof_string(&strings, "space"));
+	grd_proto_uint(&msg, 2, grd_pprof_string(&strings, "bytes"));
+	grd_proto_message(&out, 11, &msg);
+	grd_proto_uint(&out, 12, ta->sample_period ? ta->sample_period : 1);
+	grd_proto_uint(&out, 14, grd_pprof_string(&strings, "inuse_space"));
+	return out;
+}
+
+GRD_DEDUP GrdError* grd_write_heap_profile_pprof(GrdAllocator tracker, GrdUnicodeString path) {
+	auto data = grd_heap_profile_pprof(tracker);
+	grd_defer_x(data.free());
+	return write_string_to_file({ (char*) data.data, grd_len(data) }, path);
+}
+
+GRD_DEDUP GrdError* grd_write_heap_profile_collapsed(GrdAllocator tracker, GrdHeapProfileKind kind, GrdUnicodeString path) {
+	auto str = grd_heap_profile_collapsed(tracker, kind);
+	grd_defer_x(str.free());
+	return write_string_to_file(str, path);
+}
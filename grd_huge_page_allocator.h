@@ -0,0 +1,133 @@
+#pragma once
+
+#include "grd_allocator.h"
+#include "grd_panic.h"
+#include "grd_virtual_memory.h"
+#include "sync/grd_atomics.h"
+
+// Allocator of large blocks backed by huge pages, for big hash maps
+//   and arrays that are probed at random and miss the TLB on regular pages.
+// Every allocation is its own mapping of whole huge pages, so small
+//   allocations waste most of it. The whole mapping is usable size,
+//   GrdArray grows into it without reallocating.
+// Pages come from grd_os_map_huge(), grd_huge_page_kind() tells which kind a block got.
+// Blocks grow with grd_os_remap(), so a growing GrdArray isn't copied.
+
+// At the start of every mapping, mappings are aligned to huge page size.
+struct alignas(64) GrdHugePageBlock {
+	u64             mapped_size = 0;
+	GrdHugePageKind kind = GrdHugePageKind::None;
+};
+
+struct GrdHugePageAllocator {
+	GrdAllocator parent_allocator;
+	// Live blocks and their mapped bytes by GrdHugePageKind.
+	s64          blocks[3] = {};
+	s64          bytes[3] = {};
+
+	GRD_REFLECT(GrdHugePageAllocator) {}
+};
+
+GRD_DEDUP GrdHugePageBlock* grd_huge_page_block_of(void* ptr) {
+	return (GrdHugePageBlock*) ((u64) ptr & ~(grd_os_huge_page_size() - 1));
+}
+
+GRD_DEDUP GrdHugePageKind grd_huge_page_kind(void* ptr) {
+	return grd_huge_page_block_of(ptr)->kind;
+}
+
+GRD_DEDUP u64 grd_huge_page_usable_size(void* ptr) {
+	auto block = grd_huge_page_block_of(ptr);
+	return (u8*) block + block->mapped_size - (u8*) ptr;
+}
+
+GRD_DEDUP void* grd_huge_page_alloc(GrdHugePageAllocator* hp, u64 size, u64 alignment) {
+	if (alignment > grd_os_page_size()) {
+		grd_panic("GrdHugePageAllocator alignment of % is larger than page size", alignment);
+	}
+	u64 offset = grd_max_u64(sizeof(GrdHugePageBlock), alignment);
+	GrdHugePageKind kind;
+	auto block = (GrdHugePageBlock*) grd_os_map_huge(offset + size, &kind);
+	if (!block) {
+		grd_panic("Failed to map % bytes of huge pages", offset + size);
+	}
+	block->mapped_size = grd_align(offset + size, grd_os_huge_page_size());
+	block->kind = kind;
+	grd_atomic_load_add(&hp->blocks[s64(kind)], 1);
+	grd_atomic_load_add(&hp->bytes[s64(kind)], s64(block->mapped_size));
+	return (u8*) block + offset;
+}
+
+GRD_DEDUP void grd_huge_page_free(GrdHugePageAllocator* hp, void* ptr) {
+	auto block = grd_huge_page_block_of(ptr);
+	s64  kind = s64(block->kind);
+	grd_atomic_load_add(&hp->blocks[kind], -1);
+	grd_atomic_load_add(&hp->bytes[kind], -s64(block->mapped_size));
+	grd_os_unmap(block, block->mapped_size);
+}
+
+GRD_DEDUP void* grd_huge_page_realloc(GrdHugePageAllocator* hp, void* ptr, u64 old_size, u64 new_size, u64 alignment) {
+	if (!ptr) {
+		return grd_huge_page_alloc(hp, new_size, alignment);
+	}
+	if (new_size <= grd_huge_page_usable_size(ptr)) {
+		return ptr;
+	}
+	// Pages are moved instead of copied where the OS can do it,
+	//   so growth doesn't need old and new block at once.
+	auto block = grd_huge_page_block_of(ptr);
+	u64  offset = (u8*) ptr - (u8*) block;
+	u64  old_mapped_size = block->mapped_size;
+	u64  new_mapped_size = grd_align(offset + new_size, grd_os_huge_page_size());
+	if (auto moved = (GrdHugePageBlock*) grd_os_remap(block, old_mapped_size, new_mapped_size, grd_os_huge_page_size())) {
+		moved->mapped_size = new_mapped_size;
+		grd_atomic_load_add(&hp->bytes[s64(moved->kind)], s64(new_mapped_size - old_mapped_size));
+		return (u8*) moved + offset;
+	}
+	void* result = grd_huge_page_alloc(hp, new_size, alignment);
+	memcpy(result, ptr, grd_min_u64(old_size, new_size));
+	grd_huge_page_free(hp, ptr);
+	return result;
+}
+
+GRD_DEDUP GrdAllocatorProcResult grd_huge_page_allocator_proc(void* allocator_data, GrdAllocatorProcParams p) {
+	auto hp = (GrdHugePageAllocator*) allocator_data;
+	switch (p.verb) {
+		case GRD_ALLOCATOR_VERB_ALLOC: {
+			void* data = grd_huge_page_alloc(hp, p.new_size, p.alignment);
+			return { .data = data, .usable_size = grd_huge_page_usable_size(data) };
+		}
+		case GRD_ALLOCATOR_VERB_REALLOC: {
+			void* data = grd_huge_page_realloc(hp, p.old_data, p.old_size, p.new_size, p.alignment);
+			return { .data = data, .usable_size = grd_huge_page_usable_size(data) };
+		}
+		case GRD_ALLOCATOR_VERB_FREE:
+			if (p.old_data) {
+				grd_huge_page_free(hp, p.old_data);
+			}
+			break;
+		case GRD_ALLOCATOR_VERB_GET_TYPE:
+			return { .allocator_type = grd_reflect_type_of<GrdHugePageAllocator>() };
+		case GRD_ALLOCATOR_VERB_FREE_ALLOCATOR:
+			// Blocks that are still live stay mapped.
+			GrdFree(hp->parent_allocator, hp);
+			break;
+	}
+	return {};
+}
+
+GRD_DEDUP GrdAllocator grd_make_huge_page_allocator(GrdAllocator parent_allocator = c_allocator) {
+	auto hp = grd_make<GrdHugePageAllocator>(parent_allocator);
+	hp->parent_allocator = parent_allocator;
+	return {
+		.proc = grd_huge_page_allocator_proc,
+		.data = hp,
+	};
+}
+
+GRD_DEDUP GrdHugePageAllocator* grd_get_huge_page_allocator(GrdAllocator allocator) {
+	if (allocator.proc != grd_huge_page_allocator_proc) {
+		return NULL;
+	}
+	return (GrdHugePageAllocator*) allocator.data;
+}
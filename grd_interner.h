@@ -0,0 +1,207 @@
+#pragma once
+
+#include "grd_hash_map.h"
+#include "grd_string.h"
+#include "grd_arena_allocator.h"
+#include "grd_scoped.h"
+#include "sync/grd_mutex.h"
+
+// Id of a string interned in GrdInterner.
+// Equal strings get equal atoms, so atoms are compared and hashed as integers.
+// Zero atom is not a string.
+struct GrdAtom {
+	u32 id = 0;
+
+	bool operator==(GrdAtom rhs) {
+		return id == rhs.id;
+	}
+
+	bool operator!=(GrdAtom rhs) {
+		return id != rhs.id;
+	}
+};
+
+GRD_DEDUP GrdHash64 grd_hash_key(GrdAtom atom) {
+	return grd_hash_map_normalize_hash(grd_hash_mix64(atom.id));
+}
+
+// Strings are spread over shards by the top bits of their hash,
+//   every shard has its own lock, map and arena.
+GRD_DEDUP constexpr u32 GRD_INTERNER_SHARDS_COUNT_LOG2 = 4;
+GRD_DEDUP constexpr u32 GRD_INTERNER_SHARDS_COUNT      = 1 << GRD_INTERNER_SHARDS_COUNT_LOG2;
+// Records of a shard live in chunks of 64, 128, 256... records.
+// Chunks never move, so an atom is resolved without taking the lock.
+GRD_DEDUP constexpr u32 GRD_INTERNER_FIRST_CHUNK_LOG2  = 6;
+GRD_DEDUP constexpr u32 GRD_INTERNER_CHUNKS_COUNT      = 32 - GRD_INTERNER_SHARDS_COUNT_LOG2 - GRD_INTERNER_FIRST_CHUNK_LOG2 + 1;
+
+template <typename T>
+struct GrdInternedString {
+	GrdSpan<T> str;
+	GrdHash64  hash;
+};
+
+template <typename T>
+struct alignas(64) GrdInternerShard {
+	GrdMutex                        mutex;
+	// Keys point into |arena|.
+	GrdHashMap<GrdSpan<T>, GrdAtom> map;
+	GrdAllocator                    arena;
+	s64                             count = 0;
+	GrdInternedString<T>*           chunks[GRD_INTERNER_CHUNKS_COUNT] = {};
+};
+
+// Thread-safe string -> GrdAtom table.
+// Every unique string is copied once and stays until the interner is freed.
+template <typename T = char32_t>
+struct GrdInterner {
+	GrdInternerShard<T>* shards = NULL;
+	GrdAllocator         allocator = c_allocator;
+	GrdCodeLoc           loc = grd_caller_loc();
+
+	void free() {
+		if (shards) {
+			for (auto i: grd_range(GRD_INTERNER_SHARDS_COUNT)) {
+				auto shard = &shards[i];
+				for (auto chunk: shard->chunks) {
+					if (chunk) {
+						GrdFree(allocator, chunk, loc);
+					}
+				}
+				shard->map.free();
+				shard->mutex.free();
+				grd_free_allocator(shard->arena);
+			}
+			GrdFree(allocator, shards, loc);
+		}
+		*this = {};
+	}
+};
+
+template <typename T>
+GRD_DEDUP void grd_make_interner(GrdInterner<T>* out_interner, GrdAllocator allocator = c_allocator, GrdCodeLoc loc = grd_caller_loc()) {
+	*out_interner = {
+		.allocator = allocator,
+		.loc = loc,
+	};
+	out_interner->shards = GrdAlloc<GrdInternerShard<T>>(allocator, GRD_INTERNER_SHARDS_COUNT, loc);
+	for (auto i: grd_range(GRD_INTERNER_SHARDS_COUNT)) {
+		auto shard = new(&out_interner->shards[i]) GrdInternerShard<T>();
+		shard->map.allocator = allocator;
+		shard->map.loc = loc;
+		shard->arena = grd_make_arena_allocator(allocator);
+		grd_make_mutex(&shard->mutex);
+	}
+}
+
+// Atom ids are ((index in shard + 1) << GRD_INTERNER_SHARDS_COUNT_LOG2) | shard index.
+GRD_DEDUP GrdAtom grd_make_atom(u64 shard_idx, u64 idx) {
+	return { u32(((idx + 1) << GRD_INTERNER_SHARDS_COUNT_LOG2) | shard_idx) };
+}
+
+template <typename T>
+GRD_DEDUP GrdInternedString<T>* grd_interner_record(GrdInternerShard<T>* shard, u64 idx) {
+	u64 j = idx + (1ull << GRD_INTERNER_FIRST_CHUNK_LOG2);
+	u32 msb = 63 - grd_count_leading_zeros(j);
+	return &shard->chunks[msb - GRD_INTERNER_FIRST_CHUNK_LOG2][j - (1ull << msb)];
+}
+
+template <typename T>
+GRD_DEDUP GrdInternedString<T>* grd_interner_record(GrdInterner<T>* interner, GrdAtom atom) {
+	assert(atom.id != 0);
+	auto shard = &interner->shards[atom.id & (GRD_INTERNER_SHARDS_COUNT - 1)];
+	return grd_interner_record(shard, (atom.id >> GRD_INTERNER_SHARDS_COUNT_LOG2) - 1);
+}
+
+template <typename T>
+GRD_DEDUP GrdInternerShard<T>* grd_interner_shard(GrdInterner<T>* interner, GrdHash64 hash) {
+	assert(interner->shards);
+	return &interner->shards[hash >> (64 - GRD_INTERNER_SHARDS_COUNT_LOG2)];
+}
+
+// Returns zero atom if |str| was never interned.
+template <typename T>
+GRD_DEDUP GrdAtom grd_find_atom(GrdInterner<T>* interner, std::type_identity_t<GrdSpan<T>> str) {
+	GrdHash64 hash = grd_hash_key(str);
+	auto shard = grd_interner_shard(interner, hash);
+	GrdScopedLock(shard->mutex);
+	GrdAtom* atom = grd_hash_map_get_value(&shard->map, str, hash);
+	return atom ? *atom : GrdAtom{};
+}
+
+template <typename T>
+GRD_DEDUP GrdAtom grd_intern(GrdInterner<T>* interner, std::type_identity_t<GrdSpan<T>> str) {
+	GrdHash64 hash = grd_hash_key(str);
+	auto shard = grd_interner_shard(interner, hash);
+	u64  shard_idx = shard - interner->shards;
+	GrdScopedLock(shard->mutex);
+	if (GrdAtom* existing = grd_hash_map_get_value(&shard->map, str, hash)) {
+		return *existing;
+	}
+
+	u64 idx = shard->count;
+	if (idx + 1 >= (1ull << (32 - GRD_INTERNER_SHARDS_COUNT_LOG2))) {
+		grd_panic("GrdInterner is out of atoms");
+	}
+	u64 j = idx + (1ull << GRD_INTERNER_FIRST_CHUNK_LOG2);
+	u32 chunk_idx = 63 - grd_count_leading_zeros(j) - GRD_INTERNER_FIRST_CHUNK_LOG2;
+	if (!shard->chunks[chunk_idx]) {
+		u64 chunk_size = 1ull << (chunk_idx + GRD_INTERNER_FIRST_CHUNK_LOG2);
+		shard->chunks[chunk_idx] = GrdAlloc<GrdInternedString<T>>(interner->allocator, chunk_size, interner->loc);
+	}
+
+	GrdSpan<T> copy = { GrdAlloc<T>(shard->arena, grd_len(str), interner->loc), grd_len(str) };
+	memcpy(copy.data, str.data, grd_len(str) * sizeof(T));
+	*grd_interner_record(shard, idx) = { copy, hash };
+	shard->count += 1;
+
+	GrdAtom atom = grd_make_atom(shard_idx, idx);
+	s64 slot = grd_hash_map_put_slot(&shard->map, copy, hash);
+	grd_hash_map_slot_value(&shard->map, slot) = atom;
+	return atom;
+}
+
+// Valid until the interner is freed.
+template <typename T>
+GRD_DEDUP GrdSpan<T> grd_atom_str(GrdInterner<T>* interner, GrdAtom atom) {
+	return grd_interner_record(interner, atom)->str;
+}
+
+// grd_hash_key() of the atom's string.
+template <typename T>
+GRD_DEDUP GrdHash64 grd_atom_hash(GrdInterner<T>* interner, GrdAtom atom) {
+	return grd_interner_record(interner, atom)->hash;
+}
+
+template <typename T>
+GRD_DEDUP s64 grd_len(GrdInterner<T>* interner) {
+	s64 count = 0;
+	for (auto i: grd_range(GRD_INTERNER_SHARDS_COUNT)) {
+		auto shard = &interner->shards[i];
+		GrdScopedLock(shard->mutex);
+		count += shard->count;
+	}
+	return count;
+}
+
+// Interner shared by the whole program, it's never freed.
+GRD_DEDUP GrdInterner<char32_t>* grd_global_interner() {
+	// Initialization of a static local is thread-safe.
+	static GrdInterner<char32_t>* interner = [] {
+		auto x = grd_make<GrdInterner<char32_t>>();
+		grd_make_interner(x);
+		return x;
+	}();
+	return interner;
+}
+
+GRD_DEDUP GrdAtom grd_intern(GrdUnicodeString str) {
+	return grd_intern(grd_global_interner(), str);
+}
+
+GRD_DEDUP GrdAtom grd_find_atom(GrdUnicodeString str) {
+	return grd_find_atom(grd_global_interner(), str);
+}
+
+GRD_DEDUP GrdUnicodeString grd_atom_str(GrdAtom atom) {
+	return grd_atom_str(grd_global_interner(), atom);
+}
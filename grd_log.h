@@ -3,6 +3,7 @@
 #include "grd_base.h"
 #include "grd_format.h"
 #include "grd_file_path.h"
+#include "grd_frozen_map.h"
 #include <ctype.h>
 
 struct GrdLogger;
@@ -63,6 +64,18 @@ GRD_DEDUP void grd_default_logger_proc(GrdLogger* logger, GrdLogInfo info, GrdUn
 	unicode_path.free();
 }
 
+// Lowercase names of GrdLogLevel values for --grd_log_level.
+GRD_DEDUP constexpr auto GRD_LOG_LEVEL_NAMES = grd_make_frozen_map<GrdString, GrdLogLevel>({
+	{ "none"_b,      GrdLogLevel::None },
+	{ "error"_b,     GrdLogLevel::Error },
+	{ "important"_b, GrdLogLevel::Important },
+	{ "warning"_b,   GrdLogLevel::Warning },
+	{ "verbose"_b,   GrdLogLevel::Verbose },
+	{ "debug"_b,     GrdLogLevel::Debug },
+	{ "trace"_b,     GrdLogLevel::Trace },
+	{ "all"_b,       GrdLogLevel::All },
+});
+
 GRD_DEDUP GrdOptional<GrdLogLevel> grd_get_cmd_line_log_level() {
 	const char* log_level_val = NULL;
 	for (auto i: grd_range(GRD_ARGC)) {
@@ -76,29 +89,17 @@ GRD_DEDUP GrdOptional<GrdLogLevel> grd_get_cmd_line_log_level() {
 	if (!log_level_val) {
 		return {};
 	}
-	auto x = grd_reflect_type_of<GrdLogLevel>();
-	if (!x) {
-		return {};
-	}
-	auto tp = grd_type_as<GrdEnumType>(x);
-	for (auto it: tp->values) {
-		// compare case independently.
-		auto a = it.name;
-		auto b = log_level_val;
-		bool match = false;
-		while (*a && *b) {
-			if (tolower(*a) != tolower(*b)) {
-				break;
-			}
-			a += 1;
-			b += 1;
-			if (*a == '\0' && *b == '\0') {
-				match = true;
-			}
-		}
-		if (match) {
-			return GrdLogLevel(it.value.u32_value);
+	// Compare case independently.
+	char lower[16];
+	s64  len = 0;
+	for (auto c = log_level_val; *c; c++) {
+		if (len >= s64(sizeof(lower))) {
+			return {};
 		}
+		lower[len++] = tolower(*c);
+	}
+	if (auto level = grd_get(&GRD_LOG_LEVEL_NAMES, GrdString{ lower, len })) {
+		return *level;
 	}
 	return {};
 }
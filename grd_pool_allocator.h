@@ -0,0 +1,239 @@
+#pragma once
+
+#include "grd_allocator.h"
+#include "grd_panic.h"
+#include "sync/grd_mutex.h"
+#include "thread/grd_thread_cache.h"
+
+// Allocator of fixed size slots for objects made and freed one by one.
+// Slots are cut from slabs of the parent allocator, freed slots go to
+//   an intrusive free list. Slabs are given back when the pool is freed.
+// Slots are aligned to 16 if slot size is a multiple of 16, to 8 otherwise.
+
+GRD_DEDUP constexpr u64 GRD_DEFAULT_POOL_SLAB_SIZE = 64 * 1024;
+// Slots start after the link to the next slab.
+GRD_DEDUP constexpr u64 GRD_POOL_SLAB_HEADER_SIZE  = 16;
+
+struct GrdPool;
+
+struct GrdPoolThreadCache: GrdThreadCacheLinks<GrdPool, GrdPoolThreadCache> {
+	void* free_list = NULL;
+	s64   count = 0;
+};
+
+struct GrdPool {
+	GrdAllocator        parent_allocator;
+	u64                 slot_size = 0;
+	u64                 slab_size = 0;
+	// Thread-safe pools move slots to and from thread caches in batches
+	//   of |batch_size|, fields below are guarded by |mutex|.
+	bool                thread_safe = false;
+	s64                 batch_size = 0;
+	GrdMutex            mutex;
+	void*               free_list = NULL;
+	// Part of the last slab that was never handed out.
+	u8*                 bump = NULL;
+	u8*                 bump_end = NULL;
+	// First word of a slab points to the next slab.
+	void*               slabs = NULL;
+	GrdPoolThreadCache* caches = NULL;
+
+	GRD_REFLECT(GrdPool) {}
+};
+
+GRD_DEDUP void* grd_pool_new_slot(GrdPool* pool) {
+	if (pool->bump == pool->bump_end) {
+		auto slab = (u8*) GrdMalloc(pool->parent_allocator, pool->slab_size);
+		*(void**) slab = pool->slabs;
+		pool->slabs = slab;
+		u64 slots_count = (pool->slab_size - GRD_POOL_SLAB_HEADER_SIZE) / pool->slot_size;
+		pool->bump = slab + GRD_POOL_SLAB_HEADER_SIZE;
+		pool->bump_end = pool->bump + slots_count * pool->slot_size;
+	}
+	void* slot = pool->bump;
+	pool->bump += pool->slot_size;
+	return slot;
+}
+
+// Takes up to |count| slots as a list, at least one.
+GRD_DEDUP void* grd_pool_central_take(GrdPool* pool, s64 count, s64* out_taken) {
+	GrdScopedLock(pool->mutex);
+	void* list = NULL;
+	s64   taken = 0;
+	while (taken < count && pool->free_list) {
+		void* slot = pool->free_list;
+		pool->free_list = *(void**) slot;
+		*(void**) slot = list;
+		list = slot;
+		taken += 1;
+	}
+	if (taken == 0) {
+		// Don't start a new slab for more than one slot.
+		do {
+			void* slot = grd_pool_new_slot(pool);
+			*(void**) slot = list;
+			list = slot;
+			taken += 1;
+		} while (taken < count && pool->bump != pool->bump_end);
+	}
+	*out_taken = taken;
+	return list;
+}
+
+// |first| .. |last| is a linked list of slots.
+GRD_DEDUP void grd_pool_central_give(GrdPool* pool, void* first, void* last) {
+	GrdScopedLock(pool->mutex);
+	*(void**) last = pool->free_list;
+	pool->free_list = first;
+}
+
+GRD_DEDUP void grd_pool_cache_release(GrdPoolThreadCache* cache, s64 count) {
+	void* first = cache->free_list;
+	void* last = first;
+	for (s64 i = 1; i < count; i++) {
+		last = *(void**) last;
+	}
+	cache->free_list = *(void**) last;
+	cache->count -= count;
+	grd_pool_central_give(cache->owner, first, last);
+}
+
+// Gives all slots of |cache| back to the pool and frees |cache|.
+GRD_DEDUP void grd_free_thread_cache(GrdPoolThreadCache* cache) {
+	auto pool = cache->owner;
+	if (cache->count > 0) {
+		grd_pool_cache_release(cache, cache->count);
+	}
+	grd_unlink_thread_cache(cache, &pool->caches, &pool->mutex);
+	GrdFree(pool->parent_allocator, cache);
+}
+
+GRD_DEDUP GrdPoolThreadCache* grd_pool_thread_cache(GrdPool* pool) {
+	return grd_get_thread_cache(pool, &pool->caches, &pool->mutex, [&] {
+		return grd_make<GrdPoolThreadCache>(pool->parent_allocator);
+	});
+}
+
+GRD_DEDUP void* grd_pool_alloc(GrdPool* pool) {
+	if (!pool->thread_safe) {
+		if (void* slot = pool->free_list) {
+			pool->free_list = *(void**) slot;
+			return slot;
+		}
+		return grd_pool_new_slot(pool);
+	}
+	auto cache = grd_pool_thread_cache(pool);
+	if (!cache) {
+		s64 taken;
+		return grd_pool_central_take(pool, 1, &taken);
+	}
+	if (!cache->free_list) {
+		cache->free_list = grd_pool_central_take(pool, pool->batch_size, &cache->count);
+	}
+	void* slot = cache->free_list;
+	cache->free_list = *(void**) slot;
+	cache->count -= 1;
+	return slot;
+}
+
+GRD_DEDUP void grd_pool_free(GrdPool* pool, void* slot) {
+	if (!pool->thread_safe) {
+		*(void**) slot = pool->free_list;
+		pool->free_list = slot;
+		return;
+	}
+	auto cache = grd_pool_thread_cache(pool);
+	if (!cache) {
+		grd_pool_central_give(pool, slot, slot);
+		return;
+	}
+	*(void**) slot = cache->free_list;
+	cache->free_list = slot;
+	cache->count += 1;
+	if (cache->count > 2 * pool->batch_size) {
+		grd_pool_cache_release(cache, pool->batch_size);
+	}
+}
+
+GRD_DEDUP GrdPool* grd_make_pool(u64 slot_size, GrdAllocator parent_allocator = c_allocator, bool thread_safe = false, u64 slab_size = GRD_DEFAULT_POOL_SLAB_SIZE) {
+	slot_size = grd_align(grd_max_u64(slot_size, sizeof(void*)), 8);
+	auto pool = grd_make<GrdPool>(parent_allocator);
+	pool->parent_allocator = parent_allocator;
+	pool->slot_size = slot_size;
+	pool->slab_size = grd_max_u64(slab_size, GRD_POOL_SLAB_HEADER_SIZE + slot_size);
+	pool->thread_safe = thread_safe;
+	pool->batch_size = grd_clamp<s64>(4, 64, 32 * 1024 / slot_size);
+	if (thread_safe) {
+		grd_make_mutex(&pool->mutex);
+	}
+	return pool;
+}
+
+// Threads that used the pool, except the calling one, must have exited.
+GRD_DEDUP void grd_free_pool(GrdPool* pool) {
+	if (pool->thread_safe) {
+		if (auto cache = grd_forget_thread_cache<GrdPoolThreadCache>(pool)) {
+			GrdFree(pool->parent_allocator, cache);
+		}
+		pool->mutex.free();
+	}
+	auto parent_allocator = pool->parent_allocator;
+	void* slab = pool->slabs;
+	while (slab) {
+		void* next = *(void**) slab;
+		GrdFree(parent_allocator, slab);
+		slab = next;
+	}
+	GrdFree(parent_allocator, pool);
+}
+
+GRD_DEDUP u64 grd_pool_slot_alignment(GrdPool* pool) {
+	return pool->slot_size % 16 == 0 ? 16 : 8;
+}
+
+GRD_DEDUP GrdAllocatorProcResult grd_pool_allocator_proc(void* allocator_data, GrdAllocatorProcParams p) {
+	auto pool = (GrdPool*) allocator_data;
+	switch (p.verb) {
+		case GRD_ALLOCATOR_VERB_ALLOC:
+		case GRD_ALLOCATOR_VERB_REALLOC:
+			if (p.new_size > pool->slot_size) {
+				grd_panic("Allocation of % bytes doesn't fit GrdPool slot of % bytes", p.new_size, pool->slot_size);
+			}
+			if (p.alignment > grd_pool_slot_alignment(pool)) {
+				grd_panic("GrdPool slots of % bytes aren't aligned to %", pool->slot_size, p.alignment);
+			}
+			if (p.verb == GRD_ALLOCATOR_VERB_REALLOC && p.old_data) {
+				return { .data = p.old_data, .usable_size = pool->slot_size };
+			}
+			return { .data = grd_pool_alloc(pool), .usable_size = pool->slot_size };
+		case GRD_ALLOCATOR_VERB_FREE:
+			if (p.old_data) {
+				grd_pool_free(pool, p.old_data);
+			}
+			break;
+		case GRD_ALLOCATOR_VERB_GET_TYPE:
+			return { .allocator_type = grd_reflect_type_of<GrdPool>() };
+		case GRD_ALLOCATOR_VERB_FREE_ALLOCATOR:
+			grd_free_pool(pool);
+			break;
+	}
+	return {};
+}
+
+GRD_DEDUP GrdAllocator grd_make_pool_allocator(u64 slot_size, GrdAllocator parent_allocator = c_allocator, bool thread_safe = false, u64 slab_size = GRD_DEFAULT_POOL_SLAB_SIZE) {
+	return {
+		.proc = grd_pool_allocator_proc,
+		.data = grd_make_pool(slot_size, parent_allocator, thread_safe, slab_size),
+	};
+}
+
+// Pool with slots for |T|, use with grd_make<T>().
+template <typename T>
+GRD_DEDUP GrdAllocator grd_make_pool_allocator(GrdAllocator parent_allocator = c_allocator, bool thread_safe = false, u64 slab_size = GRD_DEFAULT_POOL_SLAB_SIZE) {
+	static_assert(alignof(T) <= 16);
+	u64 slot_size = sizeof(T);
+	if (alignof(T) > 8) {
+		slot_size = grd_align(slot_size, 16);
+	}
+	return grd_make_pool_allocator(slot_size, parent_allocator, thread_safe, slab_size);
+}
@@ -209,6 +209,16 @@ struct GrdMapType: GrdType {
 	GrdGenerator<Item*>    (*iterate)      (void* map) = NULL;
 };
 
+struct GrdSetType: GrdType {
+	constexpr static auto KIND = grd_make_type_kind("set");
+
+	GrdType*    inner   = NULL;
+	const char* subkind = "";
+
+	s64                    (*get_count) (void* set) = NULL;
+	GrdGenerator<void*>    (*iterate)   (void* set) = NULL;
+};
+
 struct GrdFixedArrayType: GrdSpanType {
 	s64 array_size = 0;
 };
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "grd_hash.h"
+#include "grd_reflect.h"
+#include "grd_allocator.h"
+#include <concepts>
+
+// Hashing of GRD_REFLECT structs without a hand written hash().
+// Opt in with GRD_REFLECT_HASH(T) next to GRD_REFLECT(T).
+// Only member bytes are hashed, padding is skipped.
+// Members are hashed by value, recursively through reflected struct members
+//   and fixed arrays. Members that own memory (spans, arrays, maps) are not supported,
+//   write a hash() for such types. Hashing one aborts on the first use.
+//
+// Member layout is read from reflection once per type and turned into
+//   a list of byte runs, adjacent members are fused into one run.
+// Result is the same as grd_update() of every member in order.
+
+struct GrdReflectHashRun {
+	s32 offset = 0;
+	s32 size   = 0;
+};
+
+struct GrdReflectHashPlan {
+	GrdReflectGrdArray<GrdReflectHashRun> runs;
+	// Sum of run sizes.
+	s64                                   size = 0;
+};
+
+GRD_DEDUP void grd_reflect_hash_plan_add_bytes(GrdReflectHashPlan* plan, s32 offset, s32 size) {
+	plan->size += size;
+	if (plan->runs.count > 0) {
+		auto last = plan->runs[plan->runs.count - 1];
+		if (last->offset + last->size == offset) {
+			last->size += size;
+			return;
+		}
+	}
+	plan->runs.add({ offset, size });
+}
+
+GRD_DEDUP void grd_reflect_hash_plan_add(GrdReflectHashPlan* plan, GrdType* type, s32 offset) {
+	if (auto prim = grd_type_as<GrdPrimitiveType>(type)) {
+		assert(prim->primitive_kind != GrdPrimitiveKind::P_void);
+		grd_reflect_hash_plan_add_bytes(plan, offset, prim->size);
+	} else if (grd_type_as<GrdPointerType>(type) || grd_type_as<GrdEnumType>(type) || grd_type_as<GrdFunctionType>(type)) {
+		grd_reflect_hash_plan_add_bytes(plan, offset, type->size);
+	} else if (auto st = grd_type_as<GrdStructType>(type)) {
+		for (auto it: st->members) {
+			grd_reflect_hash_plan_add(plan, it.type, offset + it.offset);
+		}
+	} else if (auto span = grd_type_as<GrdSpanType>(type); span && strcmp(span->subkind, "fixed_array") == 0) {
+		auto arr = (GrdFixedArrayType*) span;
+		for (s64 i = 0; i < arr->array_size; i++) {
+			grd_reflect_hash_plan_add(plan, arr->inner, offset + s32(i * arr->inner->size));
+		}
+	} else {
+		// Leaving the member out would make different keys equal.
+		fprintf(stderr, "Member type %s can't be hashed from reflection, write a hash()\n", type->name);
+		abort();
+	}
+}
+
+template <typename T>
+GRD_DEDUP GrdReflectHashPlan* grd_reflect_hash_plan() {
+	// Initialization of a static local is thread-safe.
+	// Lives as long as the reflected types.
+	static GrdReflectHashPlan* plan = [] {
+		auto plan = grd_make<GrdReflectHashPlan>();
+		grd_reflect_hash_plan_add(plan, grd_reflect_type_of<T>(), 0);
+		return plan;
+	}();
+	return plan;
+}
+
+// Names the struct itself, so derived structs don't inherit the opt-in.
+#define GRD_REFLECT_HASH(_T) using GrdReflectHashSelf = _T
+
+template <typename T>
+concept GrdReflectHashable =
+	std::is_class_v<T> && !GrdMemberHashable<T> &&
+	requires { requires std::same_as<typename T::GrdReflectHashSelf, T>; } && (
+		requires (T* x) { { T::grd_reflect_create_type(x) } -> std::same_as<GrdStructType*>; } ||
+		requires (T* x) { { grd_reflect_create_type(x) }    -> std::same_as<GrdStructType*>; });
+
+// Makes reflected structs GrdGlobalHashable, so grd_hash64(), grd_update()
+//   and hash map keys work with them.
+template <GrdReflectHashable T>
+GRD_DEDUP void grd_type_hash(GrdHasher* h, T x) {
+	auto plan = grd_reflect_hash_plan<T>();
+	// Gathered member bytes go to the hasher in one call.
+	if (plan->size <= 256) {
+		u8  buf[256];
+		u64 filled = 0;
+		for (auto run: plan->runs) {
+			memcpy(buf + filled, grd_ptr_add(&x, run.offset), run.size);
+			filled += run.size;
+		}
+		grd_update(h, buf, filled);
+	} else {
+		for (auto run: plan->runs) {
+			grd_update(h, grd_ptr_add(&x, run.offset), run.size);
+		}
+	}
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "grd_span.h"
+#include "grd_allocator.h"
+
+// Array that keeps its first |N| items inline and goes to |allocator|
+//   only when it outgrows them, for the many arrays that stay short.
+// Works wherever GrdSpan<T> does, but |data| may point into the array itself,
+//   so it must not be moved with memcpy(). Keep it in structs that stay put,
+//   not as an item of GrdArray.
+// Copies share the allocated items, like copies of GrdArray do.
+template <typename T, s64 N>
+struct GrdSmallArray: GrdSpan<T> {
+	static_assert(N > 0);
+
+	using GrdSpan<T>::data;
+	using GrdSpan<T>::count;
+
+	s64             capacity  = N;
+	GrdAllocator    allocator = c_allocator;
+	alignas(T) u8   inline_storage[N * sizeof(T)];
+
+	GrdSmallArray(GrdAllocator allocator = c_allocator): allocator(allocator) {
+		data = inline_data();
+	}
+
+	GrdSmallArray(const GrdSmallArray& rhs) {
+		*this = rhs;
+	}
+
+	GrdSmallArray& operator=(const GrdSmallArray& rhs) {
+		count     = rhs.count;
+		capacity  = rhs.capacity;
+		allocator = rhs.allocator;
+		if (rhs.is_inline()) {
+			memcpy(inline_storage, rhs.inline_storage, count * sizeof(T));
+			data = inline_data();
+		} else {
+			data = rhs.data;
+		}
+		return *this;
+	}
+
+	T* inline_data() {
+		return (T*) inline_storage;
+	}
+
+	bool is_inline() const {
+		return data == (const T*) inline_storage;
+	}
+
+	void free(GrdCodeLoc loc = grd_caller_loc()) {
+		if (!is_inline()) {
+			GrdFree(allocator, data, loc);
+		}
+		data     = inline_data();
+		count    = 0;
+		capacity = N;
+	}
+};
+
+template <typename T, s64 N>
+GRD_DEDUP T* grd_reserve(GrdSmallArray<T, N>* arr, s64 length, s64 index = -1, GrdCodeLoc loc = grd_caller_loc()) {
+	if (index < 0) {
+		index += grd_len(*arr) + 1;
+	}
+
+	assert(length >= 0);
+	assert(index >= 0);
+	assert(index <= grd_len(*arr));
+
+	s64 target_capacity = grd_len(*arr) + length;
+	if (target_capacity > arr->capacity) {
+		u64 new_size = grd_max(arr->capacity * 2, target_capacity) * sizeof(T);
+		u64 usable_size;
+		if (arr->is_inline()) {
+			auto data = (T*) GrdMallocAligned(arr->allocator, new_size, alignof(T), &usable_size, loc);
+			memcpy(data, arr->data, grd_len(*arr) * sizeof(T));
+			arr->data = data;
+		} else {
+			arr->data = (T*) GrdReallocAligned(arr->allocator, arr->data, arr->capacity * sizeof(T), new_size, alignof(T), &usable_size, loc);
+		}
+		arr->capacity = usable_size / sizeof(T);
+	}
+
+	memmove(arr->data + index + length, arr->data + index, (grd_len(*arr) - index) * sizeof(T));
+	arr->count += length;
+	return arr->data + index;
+}
+
+template <typename T, s64 N>
+GRD_DEDUP T* grd_add(GrdSmallArray<T, N>* arr, std::type_identity_t<T> item, s64 index = -1, GrdCodeLoc loc = grd_caller_loc()) {
+	T* ptr = grd_reserve(arr, 1, index, loc);
+	*ptr = item;
+	return ptr;
+}
+
+template <typename T, s64 N>
+GRD_DEDUP T* grd_add(GrdSmallArray<T, N>* arr, T* src, s64 length, s64 index = -1, GrdCodeLoc loc = grd_caller_loc()) {
+	T* ptr = grd_reserve(arr, length, index, loc);
+	for (auto i: grd_range(length)) {
+		ptr[i] = src[i];
+	}
+	return ptr;
+}
+
+template <typename T, s64 N>
+GRD_DEDUP T* grd_add(GrdSmallArray<T, N>* arr, GrdSpan<T> src, s64 index = -1, GrdCodeLoc loc = grd_caller_loc()) {
+	return grd_add(arr, src.data, src.count, index, loc);
+}
+
+template <typename T, s64 N>
+GRD_DEDUP T* grd_add(GrdSmallArray<T, N>* arr, std::initializer_list<std::type_identity_t<T>> list, s64 index = -1, GrdCodeLoc loc = grd_caller_loc()) {
+	return grd_add(arr, (T*) list.begin(), list.size(), index, loc);
+}
+
+template <typename T, s64 N>
+GRD_DEDUP void grd_clear(GrdSmallArray<T, N>* arr, GrdCodeLoc loc = grd_caller_loc()) {
+	arr->count = 0;
+}
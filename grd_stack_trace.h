@@ -27,6 +27,13 @@
 #include "grd_code_location.h"
 #include "sync/grd_spinlock.h"
 #include <stdarg.h>
+#if GRD_OS_WINDOWS
+	#include "grd_win32_api.h"
+#elif GRD_IS_POSIX
+	#include <execinfo.h>
+	#include <dlfcn.h>
+	#include <cxxabi.h>
+#endif
 
 struct GrdStackTraceEntry {
 	void*        addr = NULL;
@@ -233,3 +240,63 @@ GRD_DEDUP void grd_print_stack_trace(GrdStackTrace st, u32 flags = GRD_STACK_TRA
 	grd_print_stack_trace(st, buf, sizeof(buf), GRD_STACK_TRACE_PRINT_SOURCE);
 	printf("%s\n", buf);
 }
+
+// Return addresses on the calling thread's stack, innermost first, without symbols.
+// |out[0]| is in the caller of this function, |skip| drops more frames.
+// Cheap enough to call on every sampled allocation.
+GRD_DEDUP GRD_NO_INLINE s64 grd_capture_stack(void** out, s64 max_count, s64 skip = 0) {
+	void* frames[128];
+	s64 want = grd_min(max_count + skip + 1, s64(grd_static_array_count(frames)));
+#if GRD_OS_WINDOWS
+	s64 count = RtlCaptureStackBackTrace(0, GRD_WIN_DWORD(want), frames, NULL);
+#elif GRD_IS_POSIX
+	s64 count = backtrace(frames, int(want));
+#else
+	s64 count = 0;
+#endif
+	s64 result = grd_max(count - skip - 1, s64(0));
+	result = grd_min(result, max_count);
+	for (auto i: grd_range(result)) {
+		out[i] = frames[i + skip + 1];
+	}
+	return result;
+}
+
+struct GrdStackAddressInfo {
+	// Demangled if possible, NULL if unknown.
+	const char* func = NULL;
+	// Executable or shared library, NULL if unknown.
+	const char* obj = NULL;
+	// Address |obj| is loaded at.
+	void*       obj_base = NULL;
+};
+
+// Looks up symbol of |addr| in dynamic symbol tables, so on Linux
+//   functions of the executable are only found when it's linked with -rdynamic.
+// Strings are allocated with |allocator|.
+GRD_DEDUP GrdStackAddressInfo grd_stack_address_info(void* addr, GrdAllocator allocator = c_allocator) {
+	GrdStackAddressInfo info;
+#if GRD_IS_POSIX
+	Dl_info dl = {};
+	if (!dladdr(addr, &dl)) {
+		return info;
+	}
+	auto copy = [&](const char* str) -> const char* {
+		u64  len = strlen(str);
+		auto mem = GrdAlloc<char>(allocator, len + 1);
+		memcpy(mem, str, len + 1);
+		return mem;
+	};
+	info.obj_base = dl.dli_fbase;
+	if (dl.dli_fname) {
+		info.obj = copy(dl.dli_fname);
+	}
+	if (dl.dli_sname) {
+		int   status = 0;
+		char* demangled = abi::__cxa_demangle(dl.dli_sname, NULL, NULL, &status);
+		info.func = copy(status == 0 && demangled ? demangled : dl.dli_sname);
+		free(demangled);
+	}
+#endif
+	return info;
+}
@@ -1,14 +1,14 @@
 #pragma once
 
 #include "grd_allocator.h"
-#include "grd_hash_map.h"
+#include "grd_hash_set.h"
 #include "grd_type_utils.h"
 #include "grd_stopwatch.h"
 #include "grd_defer.h"
 
 struct GrdSubAllocator {
-	GrdAllocator                      parent;
-	GrdHashMap<void*, GrdEmptyStruct> map;
+	GrdAllocator      parent;
+	GrdHashSet<void*> map;
 };
 
 GRD_DEDUP GrdAllocatorProcResult grd_sub_allocator_proc(void* allocator_data, GrdAllocatorProcParams p) {
@@ -16,7 +16,7 @@ GRD_DEDUP GrdAllocatorProcResult grd_sub_allocator_proc(void* allocator_data, Gr
 	switch (p.verb) {
 		case GRD_ALLOCATOR_VERB_ALLOC: {
 			auto res = x->parent.proc(x->parent.data, p);
-			grd_put(&x->map, res.data);
+			grd_add(&x->map, res.data);
 			return res;
 		}
 		break;
@@ -24,7 +24,7 @@ GRD_DEDUP GrdAllocatorProcResult grd_sub_allocator_proc(void* allocator_data, Gr
 			auto res = x->parent.proc(x->parent.data, p);
 			if (p.old_data != res.data) {
 				grd_remove(&x->map, p.old_data);
-				grd_put(&x->map, res.data);
+				grd_add(&x->map, res.data);
 			}
 			return res;
 		}
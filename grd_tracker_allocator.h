@@ -1,28 +1,68 @@
 #pragma once
 
-#include "grd_hash_map.h" 
+#include "grd_concurrent_hash_map.h"
 #include "grd_arena_allocator.h"
 #include "grd_sort.h"
 #include "grd_log.h"
-#include "sync/grd_mutex.h"
+#include "sync/grd_atomics.h"
+#include "grd_random.h"
+#include "grd_stack_trace.h"
+#include <math.h>
+
+GRD_DEDUP constexpr s32 GRD_TRACKER_MAX_STACK_DEPTH = 64;
+
+// Call stack that allocated memory, with totals of its allocations.
+// Totals are estimates when sampling, like the rest of the stats.
+struct GrdTrackerStack {
+	s64    live_count = 0;
+	s64    live_bytes = 0;
+	s64    allocated_count = 0;
+	s64    allocated_bytes = 0;
+	s64    frames_count = 0;
+	// Return addresses, innermost first.
+	void** frames = NULL;
+};
 
 struct GrdTrackedAlloc {
-	u64        size;
-	GrdCodeLoc initial_loc;
-	GrdCodeLoc loc;
+	u64              size;
+	// Bytes the allocation stands for in usage stats, |size| when not sampling.
+	u64              weight;
+	GrdCodeLoc       initial_loc;
+	GrdCodeLoc       loc;
+	GrdTrackerStack* stack = NULL;
 };
 
+// Mean distance in bytes between sampled allocations, like in tcmalloc.
+GRD_DEDUP constexpr u64 GRD_DEFAULT_TRACKER_SAMPLE_PERIOD = 512 * 1024;
+GRD_DEDUP constexpr u64 GRD_TRACKER_FILTER_SIZE_LOG2      = 14;
+
+// Maps are sharded by key, so allocations on different threads
+//   mostly don't wait for each other.
 struct GrdTrackerAllocator {
-	GrdAllocator                       parent_allocator;
-	GrdMutex                           mutex;
-	GrdHashMap<void*, GrdTrackedAlloc> allocations = { .allocator = null_allocator };
-	GrdHashMap<const char*,   u64>     memory_usage_by_file = { .allocator = null_allocator };
-	GrdHashMap<GrdCodeLoc, u64>        memory_usage_by_location = { .allocator = null_allocator }; 
-	u64                                memory_usage = 0;
+	GrdAllocator                                    parent_allocator;
+	// GrdTrackedAlloc is much larger than the key, keep it out of the probed arrays.
+	GrdConcurrentHashMap<void*, GrdTrackedAlloc, GRD_HASH_MAP_LAYOUT_SPLIT> allocations;
+	GrdConcurrentHashMap<const char*, u64>          memory_usage_by_file;
+	GrdConcurrentHashMap<GrdCodeLoc, u64>           memory_usage_by_location;
+	u64                                             memory_usage = 0;
+
+	// When not 0 only sampled allocations are tracked, on average one per
+	//   |sample_period| allocated bytes. Usage stats are unbiased estimates.
+	u64                                             sample_period = 0;
+	// Counts of sampled pointers by pointer hash.
+	// Freeing a pointer with zero count skips the lookup in |allocations|.
+	u32*                                            sampled_filter = NULL;
+
+	// When not 0 call stacks of up to this many frames are captured
+	//   for tracked allocations, see grd_heap_profile.h.
+	s32                                             stack_depth = 0;
+	// Keyed by hash of the frames.
+	GrdConcurrentHashMap<GrdHash64, GrdTrackerStack*> stacks;
 
 	// Hook's results are ignored, just do 'return {}'.
-	GrdAllocatorProc*                  pre_hook = NULL;
-	GrdAllocatorProc*                  post_hook = NULL;
+	// Hooks may be called from multiple threads at once.
+	GrdAllocatorProc*                               pre_hook = NULL;
+	GrdAllocatorProc*                               post_hook = NULL;
 
 	GRD_REFLECT(GrdTrackerAllocator) {
 
@@ -43,22 +83,22 @@ GRD_DEF grd_tracker_allocator_print_usage(GrdAllocator x) -> void {
 		return;
 	}
 
-	auto arena = grd_make_arena_allocator(ta->parent_allocator, 1 * 1024 * 1024);
-	grd_defer_x(grd_free_allocator(arena));
+	GrdScratchScope scratch;
+	auto arena = scratch.allocator;
 
-	GrdArray<decltype(ta->memory_usage_by_file)::Entry> by_file;
+	GrdArray<GrdHashMapEntry<const char*, u64>> by_file;
 	by_file.allocator = arena;
 
-	for (auto e: ta->memory_usage_by_file.iterate()) {
-		grd_add(&by_file, *e);
-	}
+	grd_for_each(&ta->memory_usage_by_file, [&](const char** file, u64* used) {
+		grd_add(&by_file, { .key = *file, .value = *used });
+	});
 
-	GrdArray<decltype(ta->memory_usage_by_location)::Entry> by_location;
+	GrdArray<GrdHashMapEntry<GrdCodeLoc, u64>> by_location;
 	by_location.allocator = arena;
 
-	for (auto e: ta->memory_usage_by_location.iterate()) {
-		grd_add(&by_location, *e);
-	}
+	grd_for_each(&ta->memory_usage_by_location, [&](GrdCodeLoc* loc, u64* used) {
+		grd_add(&by_location, { .key = *loc, .value = *used });
+	});
 
 	grd_sort(by_file,     [](auto& arr, auto a, auto b) { return arr[a].value < arr[b].value; });
 	grd_sort(by_location, [](auto& arr, auto a, auto b) { return arr[a].value < arr[b].value; });
@@ -89,9 +129,141 @@ GRD_DEF grd_tracker_allocator_print_usage(GrdAllocator x) -> void {
 	}
 }
 
+// Underflow is fine, |diff| may be "negative".
+GRD_DEDUP void grd_tracker_allocator_add_usage(GrdTrackerAllocator* ta, GrdCodeLoc loc, u64 diff) {
+	grd_upsert(&ta->memory_usage_by_file, loc.file, [&](u64* used, bool inserted) {
+		*used += diff;
+	});
+	grd_upsert(&ta->memory_usage_by_location, loc, [&](u64* used, bool inserted) {
+		*used += diff;
+	});
+	grd_atomic_load_add(&ta->memory_usage, diff);
+}
+
+// Per-thread sampler, restarted when the thread switches to another tracker.
+struct GrdTrackerSampler {
+	GrdTrackerAllocator* ta = NULL;
+	s64                  bytes_left = 0;
+	RandomState          random;
+};
+
+GRD_DEDUP thread_local GrdTrackerSampler grd_tracker_sampler;
+
+// Distances between samples are exponential, so every allocated byte
+//   is sampled with the same probability.
+GRD_DEDUP s64 grd_tracker_next_sample_distance(GrdTrackerSampler* sampler, u64 sample_period) {
+	f64 u = f64((grd_rand_u64(&sampler->random) >> 11) + 1) * 0x1p-53;
+	return s64(-log(u) * f64(sample_period)) + 1;
+}
+
+GRD_DEDUP bool grd_tracker_allocator_sample(GrdTrackerAllocator* ta, u64 size, u64* out_weight) {
+	if (ta->sample_period == 0) {
+		*out_weight = size;
+		return true;
+	}
+	auto sampler = &grd_tracker_sampler;
+	if (sampler->ta == ta) {
+		sampler->bytes_left -= size;
+		if (sampler->bytes_left > 0) {
+			return false;
+		}
+	} else {
+		sampler->ta = ta;
+		sampler->random = grd_make_random_state(GRD_DEFAULT_RANDOM_SEED ^ (u64) sampler);
+		sampler->bytes_left = grd_tracker_next_sample_distance(sampler, ta->sample_period) - size;
+		if (sampler->bytes_left > 0) {
+			return false;
+		}
+	}
+	sampler->bytes_left = grd_tracker_next_sample_distance(sampler, ta->sample_period);
+	// Allocation of |size| is sampled with probability 1 - e^(-size / period).
+	f64 probability = -expm1(-f64(size) / f64(ta->sample_period));
+	*out_weight = probability > 0 ? u64(f64(size) / probability) : size;
+	return true;
+}
+
+GRD_DEDUP u32* grd_tracker_filter_counter(GrdTrackerAllocator* ta, void* ptr) {
+	u64 idx = (u64(ptr) * 0x9e37'79b9'7f4a'7c15) >> (64 - GRD_TRACKER_FILTER_SIZE_LOG2);
+	return &ta->sampled_filter[idx];
+}
+
+// Allocations a tracked allocation stands for.
+GRD_DEDUP s64 grd_tracked_alloc_count(GrdTrackedAlloc* alloc) {
+	if (alloc->size == 0) {
+		return 1;
+	}
+	return grd_max(s64((alloc->weight + alloc->size / 2) / alloc->size), s64(1));
+}
+
+GRD_DEDUP GrdTrackerStack* grd_tracker_allocator_stack(GrdTrackerAllocator* ta, void** frames, s64 frames_count) {
+	GrdHash64 hash = grd_hash64(frames, frames_count * sizeof(void*));
+	GrdTrackerStack* stack = NULL;
+	if (grd_get(&ta->stacks, hash, &stack)) {
+		return stack;
+	}
+	auto created = (GrdTrackerStack*) GrdMalloc(ta->parent_allocator, sizeof(GrdTrackerStack) + frames_count * sizeof(void*));
+	*created = {
+		.frames_count = frames_count,
+		.frames = (void**) (created + 1),
+	};
+	memcpy(created->frames, frames, frames_count * sizeof(void*));
+	// Another thread may have added the same stack meanwhile.
+	stack = grd_get_or_insert(&ta->stacks, hash, created);
+	if (stack != created) {
+		GrdFree(ta->parent_allocator, created);
+	}
+	return stack;
+}
+
+GRD_DEDUP void grd_tracker_stack_add(GrdTrackerStack* stack, GrdTrackedAlloc* alloc, s64 sign) {
+	s64 count = grd_tracked_alloc_count(alloc);
+	grd_atomic_load_add(&stack->live_count, sign * count);
+	grd_atomic_load_add(&stack->live_bytes, sign * s64(alloc->weight));
+	if (sign > 0) {
+		grd_atomic_load_add(&stack->allocated_count, count);
+		grd_atomic_load_add(&stack->allocated_bytes, s64(alloc->weight));
+	}
+}
+
+// Not inlined, so the number of its own and tracker's frames on the stack is known.
+GRD_DEDUP GRD_NO_INLINE void grd_tracker_allocator_record(GrdTrackerAllocator* ta, void* ptr, GrdTrackedAlloc alloc) {
+	if (ta->stack_depth > 0) {
+		void* frames[GRD_TRACKER_MAX_STACK_DEPTH];
+		// Skips this function and grd_tracker_allocator_proc().
+		s64 frames_count = grd_capture_stack(frames, ta->stack_depth, 2);
+		alloc.stack = grd_tracker_allocator_stack(ta, frames, frames_count);
+		grd_tracker_stack_add(alloc.stack, &alloc, 1);
+	}
+	grd_put(&ta->allocations, ptr, alloc);
+	if (ta->sample_period) {
+		grd_atomic_load_add(grd_tracker_filter_counter(ta, ptr), 1);
+	}
+	grd_tracker_allocator_add_usage(ta, alloc.initial_loc, alloc.weight);
+}
+
+GRD_DEDUP bool grd_tracker_allocator_forget(GrdTrackerAllocator* ta, void* ptr, GrdTrackedAlloc* out_alloc) {
+	if (ta->sample_period) {
+		// A pointer is freed after its allocation returned,
+		//   so the count of a sampled pointer is visible here without a fence.
+		if (*(volatile u32*) grd_tracker_filter_counter(ta, ptr) == 0) {
+			return false;
+		}
+	}
+	if (!grd_remove(&ta->allocations, ptr, out_alloc)) {
+		return false;
+	}
+	if (ta->sample_period) {
+		grd_atomic_load_add(grd_tracker_filter_counter(ta, ptr), -1);
+	}
+	if (out_alloc->stack) {
+		grd_tracker_stack_add(out_alloc->stack, out_alloc, -1);
+	}
+	grd_tracker_allocator_add_usage(ta, out_alloc->initial_loc, -out_alloc->weight);
+	return true;
+}
+
 GRD_DEDUP GrdAllocatorProcResult grd_tracker_allocator_proc(void* allocator_data, GrdAllocatorProcParams params) {
 	auto* ta = (GrdTrackerAllocator*) allocator_data;
-	GrdScopedLock(ta->mutex);
 
 	if (ta->pre_hook) {
 		ta->pre_hook(ta, params);
@@ -106,73 +278,58 @@ GRD_DEDUP GrdAllocatorProcResult grd_tracker_allocator_proc(void* allocator_data
 	switch (params.verb) {
 		case GRD_ALLOCATOR_VERB_ALLOC: {
 			auto result = ta->parent_allocator.proc(ta->parent_allocator.data, params);
-			grd_put(&ta->allocations, result.data, GrdTrackedAlloc {
-				.size = params.new_size,
-				.initial_loc = params.loc,
-				.loc = params.loc
-			});
-
-			u64* used = grd_get(&ta->memory_usage_by_file, params.loc.file);
-			if (!used) {
-				grd_put(&ta->memory_usage_by_file, params.loc.file, params.new_size);
-			} else {
-				*used += params.new_size;
+			u64 weight;
+			if (grd_tracker_allocator_sample(ta, params.new_size, &weight)) {
+				grd_tracker_allocator_record(ta, result.data, GrdTrackedAlloc {
+					.size = params.new_size,
+					.weight = weight,
+					.initial_loc = params.loc,
+					.loc = params.loc
+				});
 			}
-
-			used = grd_get(&ta->memory_usage_by_location, params.loc);
-			if (!used) {
-				grd_put(&ta->memory_usage_by_location, params.loc, params.new_size);
-			} else {
-				*used += params.new_size;
-			}
-			ta->memory_usage += params.new_size;
 			return result;
 		}
 		break;
 		case GRD_ALLOCATOR_VERB_REALLOC: {
-			GrdTrackedAlloc found_allocation = *grd_get(&ta->allocations, params.old_data);
-			grd_remove(&ta->allocations, params.old_data);
+			GrdTrackedAlloc found_allocation;
+			bool found = params.old_data && grd_tracker_allocator_forget(ta, params.old_data, &found_allocation);
+			assert(found || !params.old_data || ta->sample_period);
 
 			auto new_alloc = ta->parent_allocator.proc(ta->parent_allocator.data, params);
 
-			// Underflow because old_size > new_size is fine.
-			u64 diff = params.new_size - params.old_size;
-			ta->memory_usage += diff;
-
-			u64* used = grd_get(&ta->memory_usage_by_file, found_allocation.initial_loc.file);
-			*used += diff;
-
-			used = grd_get(&ta->memory_usage_by_location, found_allocation.initial_loc);
-			*used += diff;
-
-			grd_put(&ta->allocations, new_alloc.data, GrdTrackedAlloc {
-				.size = params.new_size,
-				.initial_loc = found_allocation.initial_loc,
-				.loc = params.loc
-			});
+			// Sampled as a new allocation, when sampling the old one may not have been.
+			u64 weight;
+			if (grd_tracker_allocator_sample(ta, params.new_size, &weight)) {
+				grd_tracker_allocator_record(ta, new_alloc.data, GrdTrackedAlloc {
+					.size = params.new_size,
+					.weight = weight,
+					.initial_loc = found ? found_allocation.initial_loc : params.loc,
+					.loc = params.loc
+				});
+			}
 			return new_alloc;
 		}
 		break;
 		case GRD_ALLOCATOR_VERB_FREE: {
-			auto found_alloc = *grd_get(&ta->allocations, params.old_data);
-			ta->memory_usage -= found_alloc.size;
-			u64* used = grd_get(&ta->memory_usage_by_file, found_alloc.initial_loc.file);
-			*used -= found_alloc.size;
-			used = grd_get(&ta->memory_usage_by_location, found_alloc.initial_loc);
-			*used -= found_alloc.size;
-			grd_remove(&ta->allocations, params.old_data);
+			GrdTrackedAlloc found_alloc;
+			bool found = grd_tracker_allocator_forget(ta, params.old_data, &found_alloc);
+			assert(found || ta->sample_period);
 
 			return ta->parent_allocator.proc(ta->parent_allocator.data, params);
 		}
 		break;
 
 		case GRD_ALLOCATOR_VERB_FREE_ALLOCATOR: {
-			grd_lock(&ta->mutex);
 			ta->allocations.free();
 			ta->memory_usage_by_file.free();
 			ta->memory_usage_by_location.free();
-			grd_unlock(&ta->mutex);
-			ta->mutex.free();
+			if (ta->sampled_filter) {
+				GrdFree(ta->parent_allocator, ta->sampled_filter);
+			}
+			grd_for_each(&ta->stacks, [&](GrdHash64* hash, GrdTrackerStack** stack) {
+				GrdFree(ta->parent_allocator, *stack);
+			});
+			ta->stacks.free();
 			return {};
 		}
 		break;
@@ -186,13 +343,23 @@ GRD_DEDUP GrdAllocatorProcResult grd_tracker_allocator_proc(void* allocator_data
 	}
 }
 
-GRD_DEF grd_make_tracker_allocator(GrdAllocator parent_allocator = c_allocator) -> GrdAllocator {
+// |sample_period| 0 tracks every allocation,
+//   otherwise see GrdTrackerAllocator::sample_period.
+// |stack_depth| is clamped to GRD_TRACKER_MAX_STACK_DEPTH.
+GRD_DEF grd_make_tracker_allocator(GrdAllocator parent_allocator = c_allocator, u64 sample_period = 0, s32 stack_depth = 0) -> GrdAllocator {
 	auto ta = grd_make<GrdTrackerAllocator>();
 	ta->parent_allocator = parent_allocator;
-	ta->memory_usage_by_file.allocator = parent_allocator;
-	ta->memory_usage_by_location.allocator = parent_allocator;
-	ta->allocations.allocator = parent_allocator;
-	grd_make_mutex(&ta->mutex);
+	ta->sample_period = sample_period;
+	ta->stack_depth = grd_min(stack_depth, GRD_TRACKER_MAX_STACK_DEPTH);
+	if (sample_period) {
+		u64 filter_size = sizeof(u32) << GRD_TRACKER_FILTER_SIZE_LOG2;
+		ta->sampled_filter = (u32*) GrdMalloc(parent_allocator, filter_size);
+		memset(ta->sampled_filter, 0, filter_size);
+	}
+	grd_make_concurrent_hash_map(&ta->allocations, parent_allocator);
+	grd_make_concurrent_hash_map(&ta->memory_usage_by_file, parent_allocator);
+	grd_make_concurrent_hash_map(&ta->memory_usage_by_location, parent_allocator);
+	grd_make_concurrent_hash_map(&ta->stacks, parent_allocator);
 
 	return {
 		.proc = grd_tracker_allocator_proc,
@@ -200,11 +367,11 @@ GRD_DEF grd_make_tracker_allocator(GrdAllocator parent_allocator = c_allocator)
 	};
 }
 
+// When sampling only sampled allocations are known.
 GRD_DEF grd_tracker_allocator_is_empty(GrdAllocator x) -> bool {
 	auto ta = grd_get_tracker_allocator(x);
 	if (!ta) {
 		return true;
 	}
-	GrdScopedLock(ta->mutex);
-	return grd_len(ta->allocations) == 0;
+	return grd_len(&ta->allocations) == 0;
 }
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "grd_hash.h"
+#include "grd_file.h"
+#include "grd_tuple.h"
+#include "thread/grd_thread.h"
+
+// Tree hash of a buffer, chunks are hashed in parallel.
+// Digests are stable and may be stored, the format (version 1) is:
+//
+//   Input is split into GRD_TREE_HASH_CHUNK_SIZE chunks, the last one may be shorter.
+//   Empty input has no chunks.
+//   leaf[i] = SpookyHash128(chunk i, seed1 = GRD_TREE_HASH_LEAF_SEED.lower ^ i,
+//                                    seed2 = GRD_TREE_HASH_LEAF_SEED.upper)
+//   root    = SpookyHash128(leaf[0].lower, leaf[0].upper, ... leaf[n - 1].upper, u64 input size,
+//                           seed1 = GRD_TREE_HASH_ROOT_SEED.lower,
+//                           seed2 = GRD_TREE_HASH_ROOT_SEED.upper)
+//   All integers are little endian u64.
+//
+// Digests are not compatible with grd_hash128().
+// Changing anything above changes every stored digest.
+
+GRD_DEDUP constexpr u64 GRD_TREE_HASH_CHUNK_SIZE = 1024 * 1024;
+
+GRD_DEDUP constexpr GrdHash128 GRD_TREE_HASH_LEAF_SEED = {
+	.lower = 0x7472'6565'6c65'6166,
+	.upper = 0x2a5c'8b4e'93f1'06d7,
+};
+
+GRD_DEDUP constexpr GrdHash128 GRD_TREE_HASH_ROOT_SEED = {
+	.lower = 0x7472'6565'726f'6f74,
+	.upper = 0xc3d1'0a97'5e62'b48f,
+};
+
+GRD_DEDUP GrdHash128 grd_tree_hash_leaf(void* chunk, u64 size, u64 index) {
+	GrdHash128 result = {
+		.lower = GRD_TREE_HASH_LEAF_SEED.lower ^ index,
+		.upper = GRD_TREE_HASH_LEAF_SEED.upper,
+	};
+	spookyhash_128(chunk, size, &result.lower, &result.upper);
+	return result;
+}
+
+// Sequential tree hash of a stream.
+// Gives the same digest as grd_tree_hash128() of all the data at once.
+struct GrdTreeHasher {
+	spookyhash_context leaf;
+	spookyhash_context root;
+	u64                leaf_size = 0;
+	u64                leaves_count = 0;
+	u64                size = 0;
+};
+
+GRD_DEDUP void grd_tree_hasher_start_leaf(GrdTreeHasher* h) {
+	spookyhash_context_init(&h->leaf, GRD_TREE_HASH_LEAF_SEED.lower ^ h->leaves_count, GRD_TREE_HASH_LEAF_SEED.upper);
+	h->leaf_size = 0;
+}
+
+GRD_DEDUP GrdTreeHasher grd_make_tree_hasher() {
+	GrdTreeHasher h;
+	spookyhash_context_init(&h.root, GRD_TREE_HASH_ROOT_SEED.lower, GRD_TREE_HASH_ROOT_SEED.upper);
+	grd_tree_hasher_start_leaf(&h);
+	return h;
+}
+
+GRD_DEDUP void grd_tree_hasher_add_leaf(GrdTreeHasher* h, GrdHash128 leaf) {
+	u64 digest[2] = { leaf.lower, leaf.upper };
+	spookyhash_update(&h->root, digest, sizeof(digest));
+	h->leaves_count += 1;
+}
+
+GRD_DEDUP void grd_tree_hasher_finish_leaf(GrdTreeHasher* h) {
+	GrdHash128 leaf;
+	spookyhash_final(&h->leaf, &leaf.lower, &leaf.upper);
+	grd_tree_hasher_add_leaf(h, leaf);
+	grd_tree_hasher_start_leaf(h);
+}
+
+GRD_DEDUP void grd_update(GrdTreeHasher* h, void* data, u64 size) {
+	h->size += size;
+	while (size > 0) {
+		u64 part = grd_min(size, GRD_TREE_HASH_CHUNK_SIZE - h->leaf_size);
+		spookyhash_update(&h->leaf, data, part);
+		h->leaf_size += part;
+		data = grd_ptr_add(data, part);
+		size -= part;
+		if (h->leaf_size == GRD_TREE_HASH_CHUNK_SIZE) {
+			grd_tree_hasher_finish_leaf(h);
+		}
+	}
+}
+
+GRD_DEDUP GrdHash128 grd_hash128(GrdTreeHasher* h) {
+	if (h->leaf_size > 0) {
+		grd_tree_hasher_finish_leaf(h);
+	}
+	spookyhash_update(&h->root, &h->size, sizeof(h->size));
+	GrdHash128 result;
+	spookyhash_final(&h->root, &result.lower, &result.upper);
+	return result;
+}
+
+// |threads_count| 0 means one thread per processor.
+GRD_DEDUP GrdHash128 grd_tree_hash128(void* data, u64 size, s64 threads_count = 0) {
+	u64 leaves_count = (size + GRD_TREE_HASH_CHUNK_SIZE - 1) / GRD_TREE_HASH_CHUNK_SIZE;
+	if (threads_count <= 0) {
+		threads_count = grd_os_processor_count();
+	}
+	threads_count = grd_min(threads_count, s64(leaves_count));
+
+	GrdTreeHasher h = grd_make_tree_hasher();
+	if (threads_count <= 1) {
+		grd_update(&h, data, size);
+		return grd_hash128(&h);
+	}
+
+	struct Work {
+		u8*         data;
+		u64         size;
+		u64         leaves_count;
+		u64         next_leaf;
+		GrdHash128* leaves;
+	};
+	Work work = {
+		.data = (u8*) data,
+		.size = size,
+		.leaves_count = leaves_count,
+		.next_leaf = 0,
+		.leaves = GrdAlloc<GrdHash128>(c_allocator, leaves_count),
+	};
+	auto proc = +[](Work* work) {
+		while (true) {
+			u64 i = grd_atomic_load_add(&work->next_leaf, 1);
+			if (i >= work->leaves_count) {
+				break;
+			}
+			u64 offset = i * GRD_TREE_HASH_CHUNK_SIZE;
+			u64 chunk_size = grd_min(work->size - offset, GRD_TREE_HASH_CHUNK_SIZE);
+			work->leaves[i] = grd_tree_hash_leaf(work->data + offset, chunk_size, i);
+		}
+	};
+	auto threads = GrdAlloc<GrdThread>(c_allocator, threads_count - 1);
+	for (auto i: grd_range(threads_count - 1)) {
+		threads[i] = grd_start_thread(proc, &work);
+	}
+	proc(&work);
+	for (auto i: grd_range(threads_count - 1)) {
+		threads[i].join();
+	}
+	GrdFree(c_allocator, threads);
+
+	for (auto i: grd_range(leaves_count)) {
+		grd_tree_hasher_add_leaf(&h, work.leaves[i]);
+	}
+	GrdFree(c_allocator, work.leaves);
+	h.size = size;
+	return grd_hash128(&h);
+}
+
+// Maps the file and hashes it in parallel.
+// Files that can't be mapped or report zero size (pipes, /proc) are read
+//   and hashed on the calling thread.
+GRD_DEDUP GrdTuple<GrdHash128, GrdError*> grd_tree_hash_file(GrdFile* file, s64 threads_count = 0) {
+	auto [mapped, e] = grd_map_file(file);
+	if (!e && mapped.size > 0) {
+		GrdHash128 result = grd_tree_hash128(mapped.data, mapped.size, threads_count);
+		grd_unmap_file(&mapped);
+		return { result, NULL };
+	}
+
+	GrdTreeHasher h = grd_make_tree_hasher();
+	void* buf = GrdMalloc(c_allocator, GRD_TREE_HASH_CHUNK_SIZE);
+	grd_defer_x(GrdFree(c_allocator, buf));
+	while (true) {
+		auto [read, e] = grd_read_file(file, buf, GRD_TREE_HASH_CHUNK_SIZE);
+		if (e) {
+			return { {}, e };
+		}
+		grd_update(&h, buf, read);
+		if (read < GRD_TREE_HASH_CHUNK_SIZE) {
+			break;
+		}
+	}
+	return { grd_hash128(&h), NULL };
+}
+
+GRD_DEDUP GrdTuple<GrdHash128, GrdError*> grd_tree_hash_file(GrdUnicodeString path, s64 threads_count = 0) {
+	auto [file, e] = grd_open_file(path, GRD_FILE_READ);
+	if (e) {
+		return { {}, e };
+	}
+	grd_defer_x(grd_close_file(&file));
+	return grd_tree_hash_file(&file, threads_count);
+}
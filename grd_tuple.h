@@ -4,7 +4,7 @@
 #include <initializer_list>
 
 #define GRD_TUPLE_MEMBER(T, N) T N = {};
-#define GRD_TUPLE_HASH(T, N) update(hasher, N);
+#define GRD_TUPLE_HASH(T, N) , N
 #define GRD_TUPLE_EQ(T, N) if (N != rhs.N) return false;
 
 template <typename... Args>
@@ -31,7 +31,7 @@ struct GrdTuple<A> {
 	
 	GRD_TUPLE_LIST(GRD_TUPLE_MEMBER)
 	void hash(GrdHasher* hasher) {
-		GRD_TUPLE_LIST(GRD_TUPLE_HASH)
+		grd_update_fused(hasher GRD_TUPLE_LIST(GRD_TUPLE_HASH));
 	}
 	bool operator==(GrdTuple rhs) {
 		GRD_TUPLE_LIST(GRD_TUPLE_EQ)
@@ -50,7 +50,7 @@ struct GrdTuple<A, B> {
 
 	GRD_TUPLE_LIST(GRD_TUPLE_MEMBER)
 	void hash(GrdHasher* hasher) {
-		GRD_TUPLE_LIST(GRD_TUPLE_HASH)
+		grd_update_fused(hasher GRD_TUPLE_LIST(GRD_TUPLE_HASH));
 	}
 	bool operator==(GrdTuple rhs) {
 		GRD_TUPLE_LIST(GRD_TUPLE_EQ)
@@ -70,7 +70,7 @@ struct GrdTuple<A, B, C> {
 
 	GRD_TUPLE_LIST(GRD_TUPLE_MEMBER)
 	void hash(GrdHasher* hasher) {
-		GRD_TUPLE_LIST(GRD_TUPLE_HASH)
+		grd_update_fused(hasher GRD_TUPLE_LIST(GRD_TUPLE_HASH));
 	}
 	bool operator==(GrdTuple rhs) {
 		GRD_TUPLE_LIST(GRD_TUPLE_EQ)
@@ -91,7 +91,7 @@ struct GrdTuple<A, B, C, D> {
 
 	GRD_TUPLE_LIST(GRD_TUPLE_MEMBER)
 	void hash(GrdHasher* hasher) {
-		GRD_TUPLE_LIST(GRD_TUPLE_HASH)
+		grd_update_fused(hasher GRD_TUPLE_LIST(GRD_TUPLE_HASH));
 	}
 	bool operator==(GrdTuple rhs) {
 		GRD_TUPLE_LIST(GRD_TUPLE_EQ)
@@ -113,7 +113,7 @@ struct GrdTuple<A, B, C, D, E> {
 
 	GRD_TUPLE_LIST(GRD_TUPLE_MEMBER)
 	void hash(GrdHasher* hasher) {
-		GRD_TUPLE_LIST(GRD_TUPLE_HASH)
+		grd_update_fused(hasher GRD_TUPLE_LIST(GRD_TUPLE_HASH));
 	}
 	bool operator==(GrdTuple rhs) {
 		GRD_TUPLE_LIST(GRD_TUPLE_EQ)
@@ -136,7 +136,7 @@ struct GrdTuple<A, B, C, D, E, F> {
 
 	GRD_TUPLE_LIST(GRD_TUPLE_MEMBER)
 	void hash(GrdHasher* hasher) {
-		GRD_TUPLE_LIST(GRD_TUPLE_HASH)
+		grd_update_fused(hasher GRD_TUPLE_LIST(GRD_TUPLE_HASH));
 	}
 	bool operator==(GrdTuple rhs) {
 		GRD_TUPLE_LIST(GRD_TUPLE_EQ)
@@ -160,7 +160,7 @@ struct GrdTuple<A, B, C, D, E, F, G> {
 
 	GRD_TUPLE_LIST(GRD_TUPLE_MEMBER)
 	void hash(GrdHasher* hasher) {
-		GRD_TUPLE_LIST(GRD_TUPLE_HASH)
+		grd_update_fused(hasher GRD_TUPLE_LIST(GRD_TUPLE_HASH));
 	}
 	bool operator==(GrdTuple rhs) {
 		GRD_TUPLE_LIST(GRD_TUPLE_EQ)
@@ -185,7 +185,7 @@ struct GrdTuple<A, B, C, D, E, F, G, H> {
 
 	GRD_TUPLE_LIST(GRD_TUPLE_MEMBER)
 	void hash(GrdHasher* hasher) {
-		GRD_TUPLE_LIST(GRD_TUPLE_HASH)
+		grd_update_fused(hasher GRD_TUPLE_LIST(GRD_TUPLE_HASH));
 	}
 	bool operator==(GrdTuple rhs) {
 		GRD_TUPLE_LIST(GRD_TUPLE_EQ)
@@ -216,7 +216,7 @@ GRD_DEDUP auto* grd_tuple_get_ptr(auto* tuple) {
 }
 
 template <int N>
-GRD_DEDUP auto& tuple_get(auto tuple) {
+GRD_DEDUP auto& tuple_get(auto& tuple) {
 	return *grd_tuple_get_ptr<N>(&tuple);
 }
 
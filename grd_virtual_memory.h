@@ -0,0 +1,233 @@
+#pragma once
+
+#include "grd_base.h"
+#include "grd_pointer_math.h"
+#include "math/grd_math_base.h"
+
+#if GRD_OS_WINDOWS
+	#include "grd_win32_api.h"
+#elif GRD_IS_POSIX
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+
+// Pages straight from the OS, for allocators that manage memory themselves.
+// Mapped memory is zeroed.
+
+GRD_DEDUP u64 grd_os_page_size() {
+#if GRD_OS_WINDOWS
+	// Same on every Windows x64 and arm64 machine.
+	return 4096;
+#else
+	static u64 page_size = sysconf(_SC_PAGESIZE);
+	return page_size;
+#endif
+}
+
+// |size| is rounded up to page size. Returns NULL on failure.
+GRD_DEDUP void* grd_os_map(u64 size) {
+	size = grd_align(size, grd_os_page_size());
+#if GRD_OS_WINDOWS
+	return VirtualAlloc(NULL, size, GRD_WIN_MEM_RESERVE | GRD_WIN_MEM_COMMIT, GRD_WIN_PAGE_READWRITE);
+#else
+	void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return ptr == MAP_FAILED ? NULL : ptr;
+#endif
+}
+
+// Same as grd_os_map(), but the result is aligned to |alignment|,
+//   which must be a power of two multiple of page size.
+GRD_DEDUP void* grd_os_map_aligned(u64 size, u64 alignment) {
+	assert(grd_is_power_of_two(alignment) && alignment >= grd_os_page_size());
+	size = grd_align(size, grd_os_page_size());
+#if GRD_OS_WINDOWS
+	// Parts of a reservation can't be released on Windows.
+	// Reserve more to find an aligned address, release it and map there,
+	//   another thread may take the address in between, so retry.
+	while (true) {
+		void* probe = VirtualAlloc(NULL, size + alignment, GRD_WIN_MEM_RESERVE, GRD_WIN_PAGE_NOACCESS);
+		if (!probe) {
+			return NULL;
+		}
+		VirtualFree(probe, 0, GRD_WIN_MEM_RELEASE);
+		void* aligned = (void*) grd_align((u64) probe, alignment);
+		void* ptr = VirtualAlloc(aligned, size, GRD_WIN_MEM_RESERVE | GRD_WIN_MEM_COMMIT, GRD_WIN_PAGE_READWRITE);
+		if (ptr) {
+			return ptr;
+		}
+	}
+#else
+	u8* ptr = (u8*) grd_os_map(size + alignment);
+	if (!ptr) {
+		return NULL;
+	}
+	u8* aligned = (u8*) grd_align((u64) ptr, alignment);
+	if (aligned > ptr) {
+		munmap(ptr, aligned - ptr);
+	}
+	u64 tail = (ptr + size + alignment) - (aligned + size);
+	if (tail > 0) {
+		munmap(aligned + size, tail);
+	}
+	return aligned;
+#endif
+}
+
+// |size| must be the size the memory was mapped with.
+GRD_DEDUP void grd_os_unmap(void* ptr, u64 size) {
+#if GRD_OS_WINDOWS
+	VirtualFree(ptr, 0, GRD_WIN_MEM_RELEASE);
+#else
+	munmap(ptr, grd_align(size, grd_os_page_size()));
+#endif
+}
+
+// Reserves address space without backing memory, pages must be committed before use.
+// Returns NULL on failure. Release with grd_os_unmap().
+GRD_DEDUP void* grd_os_reserve(u64 size) {
+	size = grd_align(size, grd_os_page_size());
+#if GRD_OS_WINDOWS
+	return VirtualAlloc(NULL, size, GRD_WIN_MEM_RESERVE, GRD_WIN_PAGE_NOACCESS);
+#else
+	void* ptr = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	return ptr == MAP_FAILED ? NULL : ptr;
+#endif
+}
+
+// |ptr| and |size| must be page aligned.
+GRD_DEDUP bool grd_os_commit(void* ptr, u64 size) {
+	assert(grd_is_aligned(ptr, grd_os_page_size()) && grd_is_aligned(size, grd_os_page_size()));
+#if GRD_OS_WINDOWS
+	return VirtualAlloc(ptr, size, GRD_WIN_MEM_COMMIT, GRD_WIN_PAGE_READWRITE) != NULL;
+#else
+	return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+// Gives pages back to the OS, the range stays reserved.
+// Committing it again gives zeroed pages.
+GRD_DEDUP void grd_os_decommit(void* ptr, u64 size) {
+	assert(grd_is_aligned(ptr, grd_os_page_size()) && grd_is_aligned(size, grd_os_page_size()));
+#if GRD_OS_WINDOWS
+	VirtualFree(ptr, size, GRD_WIN_MEM_DECOMMIT);
+#else
+	madvise(ptr, size, MADV_DONTNEED);
+	mprotect(ptr, size, PROT_NONE);
+#endif
+}
+
+// Grows or shrinks a mapping from grd_os_map() without copying, pages are moved
+//   to a new range if they can't grow in place. The result is aligned to |alignment|,
+//   a power of two multiple of page size.
+// Returns NULL if it can't, |ptr| is still mapped then.
+GRD_DEDUP void* grd_os_remap(void* ptr, u64 old_size, u64 new_size, u64 alignment) {
+	assert(grd_is_power_of_two(alignment) && alignment >= grd_os_page_size());
+	old_size = grd_align(old_size, grd_os_page_size());
+	new_size = grd_align(new_size, grd_os_page_size());
+#if GRD_OS_LINUX
+	void* result;
+	// Growing in place keeps |ptr|, so only an aligned |ptr| can stay.
+	if (grd_is_aligned(ptr, alignment)) {
+		result = mremap(ptr, old_size, new_size, 0);
+		if (result != MAP_FAILED) {
+			return result;
+		}
+	}
+	// Reserve an aligned range and move the pages over it.
+	u8* range = (u8*) grd_os_reserve(new_size + alignment);
+	if (!range) {
+		return NULL;
+	}
+	u8* aligned = (u8*) grd_align((u64) range, alignment);
+	result = mremap(ptr, old_size, new_size, MREMAP_MAYMOVE | MREMAP_FIXED, aligned);
+	if (result == MAP_FAILED) {
+		munmap(range, new_size + alignment);
+		return NULL;
+	}
+	if (aligned > range) {
+		munmap(range, aligned - range);
+	}
+	u64 tail = (range + new_size + alignment) - (aligned + new_size);
+	if (tail > 0) {
+		munmap(aligned + new_size, tail);
+	}
+	return result;
+#else
+	return NULL;
+#endif
+}
+
+enum class GrdHugePageKind {
+	// Regular pages.
+	None,
+	// Pages reserved for huge pages, MAP_HUGETLB or large pages on Windows.
+	// Linux needs them set aside in vm.nr_hugepages, Windows needs
+	//   SeLockMemoryPrivilege.
+	Explicit,
+	// Transparent huge pages asked for with madvise(MADV_HUGEPAGE),
+	//   the kernel backs the range with huge pages when it can.
+	Transparent,
+};
+
+GRD_DEDUP u64 grd_os_huge_page_size() {
+#if GRD_OS_WINDOWS
+	static u64 size = grd_max_u64(GetLargePageMinimum(), 2 * 1024 * 1024);
+	return size;
+#else
+	// Default huge page size on x64 and arm64 with 4 KiB pages.
+	return 2 * 1024 * 1024;
+#endif
+}
+
+GRD_DEDUP bool grd_os_transparent_huge_pages_enabled() {
+#if GRD_OS_LINUX
+	static bool enabled = [] {
+		FILE* file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+		if (!file) {
+			return false;
+		}
+		char buf[128] = {};
+		fread(buf, 1, sizeof(buf) - 1, file);
+		fclose(file);
+		return strstr(buf, "[never]") == NULL;
+	}();
+	return enabled;
+#else
+	return false;
+#endif
+}
+
+// Maps |size| rounded up to huge page size, aligned to huge page size.
+// Tries explicit huge pages, then transparent ones, then regular pages,
+//   |out_kind| gets the one it got. Returns NULL on failure.
+// Release with grd_os_unmap() and the rounded size.
+GRD_DEDUP void* grd_os_map_huge(u64 size, GrdHugePageKind* out_kind) {
+	u64 huge_page_size = grd_os_huge_page_size();
+	size = grd_align(size, huge_page_size);
+#if GRD_OS_WINDOWS
+	void* ptr = VirtualAlloc(NULL, size, GRD_WIN_MEM_RESERVE | GRD_WIN_MEM_COMMIT | GRD_WIN_MEM_LARGE_PAGES, GRD_WIN_PAGE_READWRITE);
+	if (ptr) {
+		*out_kind = GrdHugePageKind::Explicit;
+		return ptr;
+	}
+#elif GRD_OS_LINUX
+	void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (ptr != MAP_FAILED) {
+		*out_kind = GrdHugePageKind::Explicit;
+		return ptr;
+	}
+#endif
+	void* aligned = grd_os_map_aligned(size, huge_page_size);
+	if (!aligned) {
+		return NULL;
+	}
+	*out_kind = GrdHugePageKind::None;
+#if GRD_OS_LINUX
+	if (grd_os_transparent_huge_pages_enabled() && madvise(aligned, size, MADV_HUGEPAGE) == 0) {
+		*out_kind = GrdHugePageKind::Transparent;
+	}
+#endif
+	return aligned;
+}
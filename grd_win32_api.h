@@ -204,6 +204,8 @@ extern "C" {
 	GRD_WINBASEAPI GRD_WIN_HANDLE GRD_WINAPI CreateThread(GRD_WIN32_SECURITY_ATTRIBUTES* lpThreadAttributes, u64 dwStackSize, GRD_LPTHREAD_START_ROUTINE lpStartAddress, void* lpParameter, u32 dwCreationFlags, GRD_WIN_DWORD* lpThreadId);
 	// GetThreadId
 	GRD_WINBASEAPI GRD_WIN_DWORD GRD_WINAPI GetThreadId(GRD_WIN_HANDLE thread);
+	// GetActiveProcessorCount
+	GRD_WINBASEAPI GRD_WIN_DWORD GRD_WINAPI GetActiveProcessorCount(GRD_WIN_WORD GroupNumber);
 	// GetLastError
 	GRD_WINBASEAPI u32 GRD_WINAPI GetLastError(void);
 
@@ -242,6 +244,20 @@ extern "C" {
 	GRD_WINBASEAPI GRD_WIN_BOOL GRD_WINAPI FindClose(GRD_WIN_HANDLE hFindFile);
 	// FindNextFileW
 	GRD_WINBASEAPI GRD_WIN_BOOL GRD_WINAPI FindNextFileW(GRD_WIN_HANDLE hFindFile, GRD_WIN_WIN32_FIND_DATAW* lpFindFileData);
+	// CreateFileMappingW
+	GRD_WINBASEAPI GRD_WIN_HANDLE GRD_WINAPI CreateFileMappingW(GRD_WIN_HANDLE hFile, GRD_WIN32_SECURITY_ATTRIBUTES* lpFileMappingAttributes, u32 flProtect, GRD_WIN_DWORD dwMaximumSizeHigh, GRD_WIN_DWORD dwMaximumSizeLow, const wchar_t* lpName);
+	// MapViewOfFile
+	GRD_WINBASEAPI void* GRD_WINAPI MapViewOfFile(GRD_WIN_HANDLE hFileMappingObject, u32 dwDesiredAccess, GRD_WIN_DWORD dwFileOffsetHigh, GRD_WIN_DWORD dwFileOffsetLow, u64 dwNumberOfBytesToMap);
+	// UnmapViewOfFile
+	GRD_WINBASEAPI GRD_WIN_BOOL GRD_WINAPI UnmapViewOfFile(const void* lpBaseAddress);
+	// VirtualAlloc
+	GRD_WINBASEAPI void* GRD_WINAPI VirtualAlloc(void* lpAddress, u64 dwSize, GRD_WIN_DWORD flAllocationType, GRD_WIN_DWORD flProtect);
+	// VirtualFree
+	GRD_WINBASEAPI GRD_WIN_BOOL GRD_WINAPI VirtualFree(void* lpAddress, u64 dwSize, GRD_WIN_DWORD dwFreeType);
+	// GetLargePageMinimum
+	GRD_WINBASEAPI u64 GRD_WINAPI GetLargePageMinimum(void);
+	// RtlCaptureStackBackTrace
+	GRD_WINBASEAPI GRD_WIN_WORD GRD_WINAPI RtlCaptureStackBackTrace(GRD_WIN_DWORD FramesToSkip, GRD_WIN_DWORD FramesToCapture, void** BackTrace, GRD_WIN_DWORD* BackTraceHash);
 
 	#define ERROR_NO_MORE_FILES              18L
 
@@ -258,6 +274,8 @@ extern "C" {
 	  } GRD_WIN_LARGE_INTEGER;
 
 	GRD_WINBASEAPI GRD_WIN_BOOL GRD_WINAPI QueryPerformanceCounter(GRD_WIN_LARGE_INTEGER* lpPerformanceCount);
+	// GetFileSizeEx
+	GRD_WINBASEAPI GRD_WIN_BOOL GRD_WINAPI GetFileSizeEx(GRD_WIN_HANDLE hFile, GRD_WIN_LARGE_INTEGER* lpFileSize);
 	GRD_WINBASEAPI GRD_WIN_BOOL GRD_WINAPI QueryPerformanceFrequency(GRD_WIN_LARGE_INTEGER* lpFrequency);
 
 	GRD_WINUSERAPI GRD_WIN_UINT GRD_WINAPI MapVirtualKeyW(GRD_WIN_UINT uCode, GRD_WIN_UINT uMapType);
@@ -359,6 +377,19 @@ extern "C" {
 
 #define GRD_WIN_ERROR_HANDLE_EOF                 38L
 
+#define GRD_WIN_ALL_PROCESSOR_GROUPS 0xffff
+
+#define GRD_WIN_PAGE_NOACCESS   0x01
+#define GRD_WIN_PAGE_READONLY   0x02
+#define GRD_WIN_PAGE_READWRITE  0x04
+#define GRD_WIN_FILE_MAP_READ   0x0004
+
+#define GRD_WIN_MEM_COMMIT      0x00001000
+#define GRD_WIN_MEM_RESERVE     0x00002000
+#define GRD_WIN_MEM_DECOMMIT    0x00004000
+#define GRD_WIN_MEM_RELEASE     0x00008000
+#define GRD_WIN_MEM_LARGE_PAGES 0x20000000
+
 #define GRD_WIN_PM_NOREMOVE         0x0000
 #define GRD_WIN_PM_REMOVE           0x0001
 #define GRD_WIN_PM_NOYIELD          0x0002
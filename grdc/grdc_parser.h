@@ -796,15 +796,15 @@ GrdError* grdc_add_global(GrdcParser* p, GrdcAstNode* s) {
 	return NULL;
 }
 
+GRD_DEDUP constexpr auto GRDC_TYPE_NAME_ALIASES = grd_make_frozen_map<GrdUnicodeString, GrdUnicodeString>({
+	{ U"float"_b,  U"f32"_b },
+	{ U"double"_b, U"f64"_b },
+	{ U"int"_b,    U"s32"_b },
+});
+
 GrdcAstType* grdc_find_type(GrdcParser* p, GrdUnicodeString name) {
-	if (name == "float") {
-		name = U"f32"_b;
-	}
-	if (name == "double") {
-		name = U"f64"_b;
-	}
-	if (name == "int") {
-		name = U"s32"_b;
+	if (auto alias = grd_get(&GRDC_TYPE_NAME_ALIASES, name)) {
+		name = *alias;
 	}
 
 	auto symbol = grdc_lookup_symbol(p, name);
@@ -3020,20 +3020,20 @@ void grdc_add_shader_intrinsic_func(GrdcParser* p, GrdUnicodeString name, GrdcAs
 }
 
 GrdTuple<GrdcProgram*, GrdError*> grdc_parse(GrdUnicodeString str) {
-	auto allocator = grd_make_arena_allocator();
+	auto allocator = grd_make_virtual_arena_allocator();
 	auto p = grd_make<GrdcParser>(allocator);
 	p->allocator = allocator;
 	p->program = grdc_make_ast_node<GrdcProgram>(p, {});
 	p->program->globals.allocator = p->allocator;
 	p->str = str;
 	grd_add(&p->scope, p->program);
-	for (auto it: GRDC_AST_BINARY_OPERATORS_UNSORTED) {
+	for (auto it: GRDC_AST_BINARY_OPERATORS.values) {
 		grd_add(&p->op_tokens_sorted, it.op);
 	}
-	for (auto it: GRDC_AST_PREFIX_UNARY_OPERATORS_UNSORTED) {
+	for (auto it: GRDC_AST_PREFIX_UNARY_OPERATORS.values) {
 		grd_add(&p->op_tokens_sorted, it.op);
 	}
-	for (auto it: GRDC_AST_POSTFIX_UNARY_OPERATORS_UNSORTED) {
+	for (auto it: GRDC_AST_POSTFIX_UNARY_OPERATORS.values) {
 		grd_add(&p->op_tokens_sorted, it.op);
 	}
 	grd_add(&p->op_tokens_sorted, U"[["_b);
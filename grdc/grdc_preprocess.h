@@ -11,6 +11,10 @@
 #include "../grd_sub_allocator.h"
 #include "../grd_assert.h"
 #include "../grd_one_dim_intersect.h"
+#include "../grd_frozen_map.h"
+#include "../grd_interner.h"
+#include "../grd_small_array.h"
+#include "../grd_bucket_array.h"
 
 
 enum GrdcAstOperatorFlags {
@@ -48,79 +52,82 @@ struct GrdcAstOperator {
 	}
 };
 
-GRD_DEDUP GrdcAstOperator GRDC_AST_BINARY_OPERATORS_UNSORTED[] = { 
-	{ U","_b, 10, GRDC_AST_OP_FLAG_LEFT_ASSOC },
-	{ U"="_b, 11, 0 },
-	{ U"|="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
-	{ U"^="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
-	{ U"&="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
-	{ U"<<="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
-	{ U">>="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
-	{ U"+="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
-	{ U"-="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
-	{ U"*="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
-	{ U"/="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
-	{ U"%="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
-	{ U"?"_b, 12, 0 },
-	{ U"||"_b, 13, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_BOOL | GRDC_AST_OP_FLAG_PREP },
-	{ U"&&"_b, 14, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_BOOL | GRDC_AST_OP_FLAG_PREP },
-	{ U"|"_b, 15, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
-	{ U"^"_b, 16, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
-	{ U"&"_b, 17, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
-	{ U"=="_b, 18, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_PRIMITIVE | GRDC_AST_OP_FLAG_PREP },
-	{ U"!="_b, 18, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_PRIMITIVE | GRDC_AST_OP_FLAG_PREP },
-	{ U"<"_b, 19, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
-	{ U">"_b, 19, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
-	{ U"<="_b, 19, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_PREP },
-	{ U">="_b, 19, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_PREP },
-	{ U"<<"_b, 20, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
-	{ U">>"_b, 20, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
-	{ U"+"_b, 21, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
-	{ U"-"_b, 21, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
-	{ U"*"_b, 22, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
-	{ U"/"_b, 22, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
-	{ U"%"_b, 22, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
-};
-
-GRD_DEDUP GrdcAstOperator GRDC_AST_PREFIX_UNARY_OPERATORS_UNSORTED[] = {
-	{ U"!"_b, 30, GRDC_AST_OP_FLAG_PREFIX | GRDC_AST_OP_FLAG_PREP },
-	{ U"~"_b, 30, GRDC_AST_OP_FLAG_PREFIX | GRDC_AST_OP_FLAG_PREP },
-	{ U"+"_b, 30, GRDC_AST_OP_FLAG_PREFIX | GRDC_AST_OP_FLAG_PREP },
-	{ U"-"_b, 30, GRDC_AST_OP_FLAG_PREFIX | GRDC_AST_OP_FLAG_PREP },
-	{ U"++"_b, 30, GRDC_AST_OP_FLAG_PREFIX },
-	{ U"--"_b, 30, GRDC_AST_OP_FLAG_PREFIX },
-	{ U"*"_b, 30, GRDC_AST_OP_FLAG_PREFIX },
-	{ U"&"_b, 30, GRDC_AST_OP_FLAG_PREFIX },
-};
-
-GRD_DEDUP GrdcAstOperator GRDC_AST_POSTFIX_UNARY_OPERATORS_UNSORTED[] = {
-	{ U"++"_b, 40, GRDC_AST_OP_FLAG_POSTFIX },
-	{ U"--"_b, 40, GRDC_AST_OP_FLAG_POSTFIX },
-};
+GRD_DEDUP constinit auto GRDC_AST_BINARY_OPERATORS = grd_make_frozen_map<GrdUnicodeString, GrdcAstOperator>({
+		{ U","_b, 10, GRDC_AST_OP_FLAG_LEFT_ASSOC },
+		{ U"="_b, 11, 0 },
+		{ U"|="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
+		{ U"^="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
+		{ U"&="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
+		{ U"<<="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
+		{ U">>="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
+		{ U"+="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
+		{ U"-="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
+		{ U"*="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
+		{ U"/="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
+		{ U"%="_b, 11, GRDC_AST_OP_FLAG_MOD_ASSIGN },
+		{ U"?"_b, 12, 0 },
+		{ U"||"_b, 13, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_BOOL | GRDC_AST_OP_FLAG_PREP },
+		{ U"&&"_b, 14, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_BOOL | GRDC_AST_OP_FLAG_PREP },
+		{ U"|"_b, 15, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
+		{ U"^"_b, 16, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
+		{ U"&"_b, 17, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
+		{ U"=="_b, 18, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_PRIMITIVE | GRDC_AST_OP_FLAG_PREP },
+		{ U"!="_b, 18, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_PRIMITIVE | GRDC_AST_OP_FLAG_PREP },
+		{ U"<"_b, 19, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
+		{ U">"_b, 19, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
+		{ U"<="_b, 19, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_PREP },
+		{ U">="_b, 19, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_PREP },
+		{ U"<<"_b, 20, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
+		{ U">>"_b, 20, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
+		{ U"+"_b, 21, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
+		{ U"-"_b, 21, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
+		{ U"*"_b, 22, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
+		{ U"/"_b, 22, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_NUMERIC | GRDC_AST_OP_FLAG_PREP },
+		{ U"%"_b, 22, GRDC_AST_OP_FLAG_LEFT_ASSOC | GRDC_AST_OP_FLAG_INT | GRDC_AST_OP_FLAG_PREP },
+	},
+	[](GrdcAstOperator it) { return it.op; }
+);
+
+GRD_DEDUP constinit auto GRDC_AST_PREFIX_UNARY_OPERATORS = grd_make_frozen_map<GrdUnicodeString, GrdcAstOperator>({
+		{ U"!"_b, 30, GRDC_AST_OP_FLAG_PREFIX | GRDC_AST_OP_FLAG_PREP },
+		{ U"~"_b, 30, GRDC_AST_OP_FLAG_PREFIX | GRDC_AST_OP_FLAG_PREP },
+		{ U"+"_b, 30, GRDC_AST_OP_FLAG_PREFIX | GRDC_AST_OP_FLAG_PREP },
+		{ U"-"_b, 30, GRDC_AST_OP_FLAG_PREFIX | GRDC_AST_OP_FLAG_PREP },
+		{ U"++"_b, 30, GRDC_AST_OP_FLAG_PREFIX },
+		{ U"--"_b, 30, GRDC_AST_OP_FLAG_PREFIX },
+		{ U"*"_b, 30, GRDC_AST_OP_FLAG_PREFIX },
+		{ U"&"_b, 30, GRDC_AST_OP_FLAG_PREFIX },
+	},
+	[](GrdcAstOperator it) { return it.op; }
+);
+
+GRD_DEDUP constinit auto GRDC_AST_POSTFIX_UNARY_OPERATORS = grd_make_frozen_map<GrdUnicodeString, GrdcAstOperator>({
+		{ U"++"_b, 40, GRDC_AST_OP_FLAG_POSTFIX },
+		{ U"--"_b, 40, GRDC_AST_OP_FLAG_POSTFIX },
+	},
+	[](GrdcAstOperator it) { return it.op; }
+);
 
 GRD_DEDUP GrdcAstOperator* grdc_find_binary_operator(GrdUnicodeString op, u64 req_flags) {
-	for (auto& it: GRDC_AST_BINARY_OPERATORS_UNSORTED) {
-		if (op == it.op && (req_flags & it.flags) == req_flags) {
-			return &it;
-		}
+	auto it = grd_get(&GRDC_AST_BINARY_OPERATORS, op);
+	if (it && (req_flags & it->flags) == req_flags) {
+		return it;
 	}
 	return NULL;
 }
 
 GRD_DEDUP GrdcAstOperator* grdc_find_prefix_unary_operator(GrdUnicodeString op, u64 req_flags) {
-	for (auto& it: GRDC_AST_PREFIX_UNARY_OPERATORS_UNSORTED) {
-		if (op == it.op && (req_flags & it.flags) == req_flags) {
-			return &it;
-		}
+	auto it = grd_get(&GRDC_AST_PREFIX_UNARY_OPERATORS, op);
+	if (it && (req_flags & it->flags) == req_flags) {
+		return it;
 	}
 	return NULL;
 }
 
 GRD_DEDUP GrdcAstOperator* grdc_find_postfix_unary_operator(GrdUnicodeString op, u64 req_flags) {
-	for (auto& it: GRDC_AST_POSTFIX_UNARY_OPERATORS_UNSORTED) {
-		if (op == it.op && (req_flags & it.flags) == req_flags) {
-			return &it;
-		}
+	auto it = grd_get(&GRDC_AST_POSTFIX_UNARY_OPERATORS, op);
+	if (it && (req_flags & it->flags) == req_flags) {
+		return it;
 	}
 	return NULL;
 }
@@ -225,6 +232,9 @@ struct GrdcIncludedFile;
 struct GrdcPrepFileSource;
 struct GrdcTokenSet;
 
+// Hidesets and macro arguments are mostly a few items long.
+using GrdcHideset = GrdSmallArray<GrdAtom, 4>;
+
 struct GrdcToken {
 	GrdcPrepTokenKind          kind  = GRDC_PREP_TOKEN_KIND_NONE;
 	s64                        flags = GRDC_PREP_TOKEN_FLAG_NONE;
@@ -232,6 +242,8 @@ struct GrdcToken {
 	s64                        set_idx = -1;
 	GrdcToken*                 parent = NULL;
 	GrdAllocatedUnicodeString  custom_str = { .allocator = null_allocator };
+	// Interned grdc_tok_str(), set by grdc_tok_atom().
+	GrdAtom                    atom;
 
 	GRD_REFLECT(GrdcToken) {
 		GRD_MEMBER(kind);
@@ -357,7 +369,7 @@ struct GrdcTokenSet {
 	GrdcToken*               stringize_tok = NULL;
 	GrdcTokenSlice           prescan_args;
 	GrdcPrepMacro*           macro_def = NULL;
-	GrdArray<GrdUnicodeString> hideset = { .allocator = null_allocator };
+	GrdcHideset              hideset = { null_allocator };
 
 	GrdcConcat*              concat = NULL;
 
@@ -560,7 +572,7 @@ struct GrdcPrepMacro {
 	s64                  def_start = 0;
 	s64                  def_end = 0;
 	GrdcToken*           name;
-	GrdArray<GrdcToken*> arg_defs;
+	GrdSmallArray<GrdcToken*, 4> arg_defs;
 	bool                 is_object = true;
 };
 
@@ -570,10 +582,12 @@ struct GrdcPrepMacroArg {
 	s64 end;
 };
 
+using GrdcPrepMacroArgs = GrdSmallArray<GrdcPrepMacroArg, 4>;
+
 struct GrdcMacroExp {
 	GrdcMacroExp*              parent = NULL;
 	GrdcPrepMacro*             macro = NULL;
-	GrdArray<GrdcPrepMacroArg> args;
+	GrdcPrepMacroArgs          args;
 	GrdcTokenSlice             replaced;
 	GrdcTokenSlice             before_stringize;
 	GrdcTokenSlice             after_stringize;
@@ -594,7 +608,10 @@ struct GrdcPrep {
 	GrdAllocator                   arena;
 	GrdcTokenSetParentBuilder      tokens_builder;
 	GrdArray<GrdcPrepFileSource*>  files;
-	GrdHashMap<GrdUnicodeString, GrdcPrepMacro*> macros;
+	GrdHashMap<GrdAtom, GrdcPrepMacro*> macros;
+	// Files and macros live here, the pointers above point into them.
+	GrdBucketArray<GrdcPrepFileSource, 16> file_storage;
+	GrdBucketArray<GrdcPrepMacro, 64>      macro_storage;
 	GrdcMacroExp*                  macro_exp = NULL;
 	GrdcIncludedFile*              include_site = NULL;
 	void*                          aux_data = NULL;
@@ -1521,6 +1538,7 @@ GRD_DEF grdc_use_custom_str(GrdcToken* tok, GrdAllocatedUnicodeString str) {
 	}
 	tok->flags |= GRDC_PREP_TOKEN_FLAG_CUSTOM_STR;
 	tok->custom_str = str;
+	tok->atom = {};
 }
 
 GRD_DEF grd_apply_mapping_from_removed_regions(GrdcPrepFileSource* file, GrdSpan<GrdTuple<s64, s64>> regions_to_remove, GrdArray<GrdcPrepFileMapping>* mappings) {
@@ -1859,7 +1877,7 @@ GRD_DEDUP GrdUnicodeString grdc_prep_default_resolve_fullpath_hook(GrdcPrep* p,
 }
 
 GRD_DEDUP GrdcPrepFileSource* grdc_make_mem_prep_file(GrdcPrep* p, GrdUnicodeString src, GrdUnicodeString fullpath) {
-	auto* file = grd_make<GrdcPrepFileSource>(p->allocator);
+	auto* file = grd_add(&p->file_storage, {});
 	file->og_src = src;
 	file->fullpath = fullpath;
 	file->comment_mappings.allocator = p->allocator;
@@ -1884,6 +1902,8 @@ GRD_DEDUP GrdcPrep* grdc_make_prep(GrdAllocator allocator = c_allocator) {
 	p->arena = grd_make_arena_allocator(allocator);
 	p->files.allocator = allocator;
 	p->macros.allocator = allocator;
+	p->file_storage.allocator = allocator;
+	p->macro_storage.allocator = allocator;
 	p->load_file_hook = grdc_prep_default_load_file_hook;
 	p->resolve_fullpath_hook = grdc_prep_default_resolve_fullpath_hook;
 	p->tokens_builder = grdc_make_token_set_parent_builder(p->allocator);
@@ -1992,8 +2012,8 @@ GRD_DEF grdc_get_macro_stack_len(GrdcPrep* p) -> s64 {
 	return len;
 }
 
-GRD_DEDUP GrdTuple<GrdError*, GrdArray<GrdcPrepMacroArg>> grdc_parse_macro_args(GrdcPrep* p, GrdcPrepMacro* macro, GrdcTokenSlice tokens, s64* cursor, GrdcToken* paren_tok) {
-	GrdArray<GrdcPrepMacroArg> args = { .capacity = grd_len(macro->arg_defs), .allocator = p->allocator };
+GRD_DEDUP GrdTuple<GrdError*, GrdcPrepMacroArgs> grdc_parse_macro_args(GrdcPrep* p, GrdcPrepMacro* macro, GrdcTokenSlice tokens, s64* cursor, GrdcToken* paren_tok) {
+	GrdcPrepMacroArgs args = { p->allocator };
 	s64 paren_level = 0;
 	s64 arg_start = -1;
 	*cursor = grdc_skip_spaces_and_line_breaks(tokens, *cursor);
@@ -2111,11 +2131,24 @@ GRD_DEDUP bool grdc_does_macro_stack_contain_macro(GrdcPrep* p, GrdcPrepMacro* m
 	return false;
 }
 
-GRD_DEDUP GrdcPrepMacro* grdc_find_macro(GrdcPrep* p, GrdUnicodeString name) {
+// Derived tokens copy the atom of their parent, so a string is interned once.
+GRD_DEDUP GrdAtom grdc_tok_atom(GrdcToken* tok) {
+	if (tok->atom.id == 0) {
+		tok->atom = grd_intern(grdc_tok_str(tok));
+	}
+	return tok->atom;
+}
+
+GRD_DEDUP GrdcPrepMacro* grdc_find_macro(GrdcPrep* p, GrdAtom name) {
 	auto v = grd_get(&p->macros, name);
 	return v ? *v : NULL;
 }
 
+GRD_DEDUP GrdcPrepMacro* grdc_find_macro(GrdcPrep* p, GrdUnicodeString name) {
+	auto atom = grd_find_atom(name);
+	return atom.id ? grdc_find_macro(p, atom) : NULL;
+}
+
 GRD_DEDUP GrdOptional<GrdcTokenSlice> grdc_get_arg_tokens(GrdcPrepMacro* macro, GrdcTokenSlice tokens, GrdSpan<GrdcPrepMacroArg> args, GrdUnicodeString name) {
 	auto def_idx = grdc_find_macro_arg_def_tok_idx(macro, name);
 	if (def_idx == -1) {
@@ -2141,8 +2174,8 @@ GRD_DEDUP GrdcMacroExp* grdc_get_tok_macro_exp(GrdcPrep* p, GrdcToken* tok) {
 	return tok->set->macro_exp;
 }
 
-GRD_DEF grdc_hideset_intersection(GrdcPrep* p, GrdSpan<GrdUnicodeString> a, GrdSpan<GrdUnicodeString> b) -> GrdArray<GrdUnicodeString> {
-	GrdArray<GrdUnicodeString> result = { .allocator = p->allocator };
+GRD_DEF grdc_hideset_intersection(GrdcPrep* p, GrdSpan<GrdAtom> a, GrdSpan<GrdAtom> b) -> GrdcHideset {
+	GrdcHideset result = { p->allocator };
 	for (auto it: a) {
 		if (grd_contains(b, it)) {
 			grd_add(&result, it);
@@ -2162,7 +2195,7 @@ GRD_DEDUP GrdTuple<GrdError*, GrdcMacroExp*> grdc_maybe_expand_macro(GrdcPrep* p
 	auto log_i = GrdLogInfo { .level = GrdLogLevel::Trace, .indent = (grdc_get_macro_stack_len(p) + p->prescan_exp_level) * 1 };
 	auto exp_start = cursor;
 	auto name_tok = tokens[cursor];
-	auto macro = grdc_find_macro(p, grdc_tok_str(name_tok));
+	auto macro = grdc_find_macro(p, grdc_tok_atom(name_tok));
 	if (!macro) {
 		return { };
 	}
@@ -2185,7 +2218,7 @@ GRD_DEDUP GrdTuple<GrdError*, GrdcMacroExp*> grdc_maybe_expand_macro(GrdcPrep* p
 	}
 
 	for (auto it: name_tok->set->hideset) {
-		if (it == grdc_tok_str(name_tok)) {
+		if (it == grdc_tok_atom(name_tok)) {
 			name_tok->flags |= GRDC_PREP_TOKEN_FLAG_POISONED;
 			GrdLogWithInfo(log_i, "Recursive macro expansion prevented: %", grdc_tok_str(name_tok));
 			return { };
@@ -2204,7 +2237,7 @@ GRD_DEDUP GrdTuple<GrdError*, GrdcMacroExp*> grdc_maybe_expand_macro(GrdcPrep* p
 	// 	return { };
 	// }
 
-	GrdArray<GrdcPrepMacroArg> args = {};
+	GrdcPrepMacroArgs args;
 	if (!macro->is_object) {
 		auto [args_e, m_args] = grdc_parse_macro_args(p, macro, tokens, &cursor, paren_tok);
 		args = m_args;
@@ -2425,7 +2458,7 @@ GRD_DEDUP GrdTuple<GrdError*, GrdcMacroExp*> grdc_maybe_expand_macro(GrdcPrep* p
 			exp->replaced_before_rescan[0]->set->hideset,
 			exp->replaced_before_rescan[-1]->set->hideset
 		);
-	grd_add(&new_body.set->hideset, grdc_tok_str(name_tok));
+	grd_add(&new_body.set->hideset, grdc_tok_atom(name_tok));
 
 	GrdLogWithInfo(log_i, "%", grdc_tok_arr_str(exp->replaced_before_rescan));
 	GrdLogWithInfo(log_i, "  br: %", grdc_tok_arr_str(new_body));
@@ -2854,16 +2887,16 @@ GRD_DEDUP GrdError* grdc_handle_prep_directive(GrdcPrep* p, GrdcTokenSlice token
 		if (ident_tok->kind != GRDC_PREP_TOKEN_KIND_IDENT) {
 			return grdc_make_prep_file_error(p, grd_current_loc(), ident_tok, "Expected an identifier after #define");
 		}
-		auto macro = grd_make<GrdcPrepMacro>(p->allocator);
+		auto macro = grd_add(&p->macro_storage, {});
 		macro->def_site = p->include_site;
 		macro->def_start = start_tok_idx;
 		macro->name = ident_tok;
-		auto already_defined = grdc_find_macro(p, grdc_tok_str(macro->name));
+		auto already_defined = grdc_find_macro(p, grdc_tok_atom(macro->name));
 		if (already_defined) {
 			// @TODO: issue duplicate macro warning.
-			grd_remove(&p->macros, grdc_tok_str(macro->name));
+			grd_remove(&p->macros, grdc_tok_atom(macro->name));
 		}
-		grd_put(&p->macros, grdc_tok_str(macro->name), macro);
+		grd_put(&p->macros, grdc_tok_atom(macro->name), macro);
 		*cursor += 1;
 		if (*cursor < grd_len(tokens) &&
 			grdc_tok_str(tokens[*cursor]) == "(")
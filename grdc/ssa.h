@@ -2,6 +2,7 @@
 
 #include "grdc_parser.h"
 #include "grd_ssa_op.h"
+#include "../grd_small_array.h"
 
 struct GrdcSsaId { 
 	s64 v = 0;
@@ -23,14 +24,15 @@ struct GrdcSsaBasicBlock;
 struct GrdcSsa;
 
 struct GrdcSsaValue {
-	GrdcSsaId               id;
-	GrdSsaOp                op = GrdSsaOp::Nop;
-	GrdcSsaBasicBlock*      block = NULL;
-	GrdArray<GrdcSsaValue*> args;
-	GrdArray<GrdcSsaValue*> uses;
-	GrdAny                  aux;
-	GrdcAstType*            v_type = NULL;
-	bool                    is_removed = false; // @TODO: only for debugging. remove later.
+	GrdcSsaId                       id;
+	GrdSsaOp                        op = GrdSsaOp::Nop;
+	GrdcSsaBasicBlock*              block = NULL;
+	// Most values have a few args and uses.
+	GrdSmallArray<GrdcSsaValue*, 3> args;
+	GrdSmallArray<GrdcSsaValue*, 3> uses;
+	GrdAny                          aux;
+	GrdcAstType*                    v_type = NULL;
+	bool                            is_removed = false; // @TODO: only for debugging. remove later.
 };
 
 struct GrdcSsaBasicBlock {
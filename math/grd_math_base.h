@@ -105,3 +105,42 @@ GRD_DEDUP bool grd_is_nan(f64 x) {
 GRD_DEF grd_lerp(f64 a, f64 b, f64 t) -> f64 {
 	return a + (b - a) * t;
 }
+
+#if GRD_COMPILER_MSVC
+	#include <intrin.h>
+#endif
+
+// |x| must not be 0.
+GRD_DEDUP u32 grd_count_trailing_zeros(u64 x) {
+	assert(x != 0);
+#if GRD_COMPILER_MSVC
+	unsigned long idx;
+	_BitScanForward64(&idx, x);
+	return idx;
+#else
+	return __builtin_ctzll(x);
+#endif
+}
+
+// |x| must not be 0.
+GRD_DEDUP u32 grd_count_leading_zeros(u64 x) {
+	assert(x != 0);
+#if GRD_COMPILER_MSVC
+	unsigned long idx;
+	_BitScanReverse64(&idx, x);
+	return 63 - idx;
+#else
+	return __builtin_clzll(x);
+#endif
+}
+
+GRD_DEDUP constexpr bool grd_is_power_of_two(u64 x) {
+	return x != 0 && (x & (x - 1)) == 0;
+}
+
+GRD_DEDUP u64 grd_next_power_of_two(u64 x) {
+	if (x <= 1) {
+		return 1;
+	}
+	return 1ull << (64 - grd_count_leading_zeros(x - 1));
+}
@@ -1,80 +1,406 @@
 #pragma once
 
-#include "grd_allocator.h"
-
-struct BuddyHeader {
-	// Must be divisible by 2, so that leaves last bit usable
-	//   for indicating whether buddy is is divided or not.
-	//
-	// If level is 0, then flags & ~1 is size of the block.
-	u64          flags;
+#include "../grd_allocator.h"
+#include "../grd_virtual_memory.h"
+#include "../grd_scoped.h"
+#include "../grd_panic.h"
+#include "../sync/grd_mutex.h"
+#include "../thread/grd_thread_cache.h"
+
+// Size class heap with per-thread caches, a drop-in replacement for c_allocator:
+//
+//   c_allocator = grd_heap_allocator();
+//
+// Small blocks are carved from slabs, every slab holds blocks of one size class.
+// Each thread keeps free blocks of every class in its own cache,
+//   refills it from the central free list of the class in batches
+//   and gives a batch back when the cache grows too big,
+//   so the central lock is taken once per batch.
+// Blocks may be freed on any thread.
+// Allocations above the largest class are mapped directly from the OS.
+// Slabs are kept until the heap is freed.
+
+GRD_DEDUP constexpr s64 GRD_HEAP_SIZE_CLASSES[] = {
+	16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 176, 192, 208, 224, 240, 256,
+	288, 320, 352, 384, 416, 448, 480, 512, 576, 640, 704, 768, 832, 896, 960,
+	1024, 1152, 1280, 1408, 1536, 1792, 2048, 2304, 2560, 2816, 3072, 3328,
+	3648, 4096, 4480, 4992, 5504, 6016, 6528, 7040, 7680, 8224, 8832, 9472,
 };
+GRD_DEDUP constexpr s64 GRD_HEAP_SIZE_CLASSES_COUNT = grd_static_array_count(GRD_HEAP_SIZE_CLASSES);
+GRD_DEDUP constexpr u64 GRD_HEAP_MAX_SMALL_SIZE     = GRD_HEAP_SIZE_CLASSES[GRD_HEAP_SIZE_CLASSES_COUNT - 1];
+GRD_DEDUP constexpr u64 GRD_HEAP_ALIGNMENT          = 16;
 
-u64 size(BuddyHeader* header) {
-	return header->flags & ~1ull;
-}
+// Slabs are aligned to their size, so a block finds its slab by masking the address.
+GRD_DEDUP constexpr u64 GRD_HEAP_SLAB_SIZE   = 64 * 1024;
+// Slabs are mapped this many at a time.
+GRD_DEDUP constexpr u64 GRD_HEAP_CHUNK_SLABS = 32;
+
+struct GrdHeapClassTable {
+	u8 classes[GRD_HEAP_MAX_SMALL_SIZE / GRD_HEAP_ALIGNMENT + 1] = {};
+};
 
-bool is_divided(BuddyHeader* header) {
-	return (header->flags & 1ull) == 1;
+// Size class of a size is classes[(size + 15) / 16].
+GRD_DEDUP constexpr GrdHeapClassTable GRD_HEAP_CLASS_BY_SIZE = [] {
+	GrdHeapClassTable table;
+	s64 class_idx = 0;
+	for (u64 i = 0; i < grd_static_array_count(table.classes); i++) {
+		while (GRD_HEAP_SIZE_CLASSES[class_idx] < s64(i * GRD_HEAP_ALIGNMENT)) {
+			class_idx += 1;
+		}
+		table.classes[i] = u8(class_idx);
+	}
+	return table;
+}();
+
+// Blocks moved between a thread cache and the central list at once.
+GRD_DEDUP constexpr s64 grd_heap_batch_size(s64 class_idx) {
+	s64 count = 32 * 1024 / GRD_HEAP_SIZE_CLASSES[class_idx];
+	return count < 4 ? 4 : (count > 64 ? 64 : count);
 }
 
-struct BuddyAllocTrieNode {
-	u64                 num = 0;
-	BuddyAllocTrieNode* sibling = NULL;
-	BuddyAllocTrieNode* child   = NULL;
+struct GrdHeap;
+
+// At the start of every slab and every directly mapped allocation.
+struct alignas(64) GrdHeapSlab {
+	GrdHeap*     heap = NULL;
+	// -1 for directly mapped allocations.
+	s32          class_idx = -1;
+	// Directly mapped allocations only.
+	u64          mapped_size = 0;
+	GrdHeapSlab* prev = NULL;
+	GrdHeapSlab* next = NULL;
+	// Set in the first slab of a chunk.
+	GrdHeapSlab* next_chunk = NULL;
 };
 
-struct BuddyGlobalHeader {
-	GrdAllocator          parent;
-	u64                size = 0;
-	u64                metadata_size = 0;
-	BuddyAllocTrieNode trie_first;
-	BuddyHeader        first_header;
-	char               metadata_start;
+struct alignas(64) GrdHeapCentralBin {
+	GrdMutex mutex;
+	void*    free_list = NULL;
+	// Part of the last slab that was never handed out.
+	u8*      bump = NULL;
+	u8*      bump_end = NULL;
 };
 
-constexpr s64 BUDDY_SIZE_CLASSES_COUNT = 55;
+struct GrdHeapCacheBin {
+	void* free_list = NULL;
+	s64   count = 0;
+};
 
-constexpr s64 BUDDY_SIZE_CLASSES[] = {
-	16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 176, 192, 208, 224, 240, 256,
-	288, 320, 352, 384, 416, 448, 480, 512, 576, 640, 704, 768, 832, 896, 960,
-	1024, 1152, 1280, 1408, 1536, 1792, 2048, 2304, 2560, 2816, 3072, 3328,
-	3648, 4096, 4480, 4992, 5504, 6016, 6528, 7040, 7680, 8224, 8832, 9472,
+struct GrdHeapThreadCache: GrdThreadCacheLinks<GrdHeap, GrdHeapThreadCache> {
+	GrdHeapCacheBin bins[GRD_HEAP_SIZE_CLASSES_COUNT];
 };
-static_assert(grd_static_array_count(BUDDY_SIZE_CLASSES) == 55);
 
-constexpr s64 BUDDY_MIN_BLOCK_SIZE = 4096 * 8;
+struct GrdHeap {
+	GrdHeapCentralBin   bins[GRD_HEAP_SIZE_CLASSES_COUNT];
+
+	GrdMutex            slabs_mutex;
+	u8*                 next_slab = NULL;
+	u8*                 slabs_end = NULL;
+	GrdHeapSlab*        chunks = NULL;
+	GrdHeapSlab*        large = NULL;
+
+	GrdMutex            caches_mutex;
+	GrdHeapThreadCache* caches = NULL;
+
+	GRD_REFLECT(GrdHeap) {}
+};
+
+GRD_DEDUP void grd_heap_out_of_memory(u64 size) {
+	fprintf(stderr, "Failed to map %zx bytes for GrdHeap", (size_t) size);
+	GrdDebugBreak();
+	exit(-1);
+}
+
+GRD_DEDUP GrdHeapSlab* grd_heap_slab_of(void* ptr) {
+	return (GrdHeapSlab*) ((u64) ptr & ~(GRD_HEAP_SLAB_SIZE - 1));
+}
+
+GRD_DEDUP GrdHeapSlab* grd_heap_take_slab(GrdHeap* heap, s32 class_idx) {
+	GrdScopedLock(heap->slabs_mutex);
+	if (heap->next_slab == heap->slabs_end) {
+		u64 size = GRD_HEAP_SLAB_SIZE * GRD_HEAP_CHUNK_SLABS;
+		u8* chunk = (u8*) grd_os_map_aligned(size, GRD_HEAP_SLAB_SIZE);
+		if (!chunk) {
+			grd_heap_out_of_memory(size);
+		}
+		auto first = (GrdHeapSlab*) chunk;
+		first->next_chunk = heap->chunks;
+		heap->chunks = first;
+		heap->next_slab = chunk;
+		heap->slabs_end = chunk + size;
+	}
+	auto slab = (GrdHeapSlab*) heap->next_slab;
+	heap->next_slab += GRD_HEAP_SLAB_SIZE;
+	slab->heap = heap;
+	slab->class_idx = class_idx;
+	return slab;
+}
+
+// Takes up to |count| blocks from the central list, returns them linked.
+GRD_DEDUP void* grd_heap_central_take(GrdHeap* heap, s32 class_idx, s64 count, s64* out_taken) {
+	auto bin = &heap->bins[class_idx];
+	u64  size = GRD_HEAP_SIZE_CLASSES[class_idx];
+	GrdScopedLock(bin->mutex);
+	void* list = NULL;
+	s64   taken = 0;
+	while (taken < count && bin->free_list) {
+		void* block = bin->free_list;
+		bin->free_list = *(void**) block;
+		*(void**) block = list;
+		list = block;
+		taken += 1;
+	}
+	while (taken < count) {
+		if (u64(bin->bump_end - bin->bump) < size) {
+			if (taken > 0) {
+				break;
+			}
+			auto slab = grd_heap_take_slab(heap, class_idx);
+			bin->bump = (u8*) slab + sizeof(GrdHeapSlab);
+			bin->bump_end = bin->bump + (GRD_HEAP_SLAB_SIZE - sizeof(GrdHeapSlab)) / size * size;
+		}
+		void* block = bin->bump;
+		bin->bump += size;
+		*(void**) block = list;
+		list = block;
+		taken += 1;
+	}
+	*out_taken = taken;
+	return list;
+}
+
+// |first| .. |last| are linked blocks.
+GRD_DEDUP void grd_heap_central_give(GrdHeap* heap, s32 class_idx, void* first, void* last) {
+	auto bin = &heap->bins[class_idx];
+	GrdScopedLock(bin->mutex);
+	*(void**) last = bin->free_list;
+	bin->free_list = first;
+}
+
+GRD_DEDUP void grd_heap_cache_release(GrdHeap* heap, GrdHeapCacheBin* bin, s32 class_idx, s64 count) {
+	void* first = bin->free_list;
+	void* last = first;
+	for (s64 i = 1; i < count; i++) {
+		last = *(void**) last;
+	}
+	bin->free_list = *(void**) last;
+	bin->count -= count;
+	grd_heap_central_give(heap, class_idx, first, last);
+}
+
+// Gives all blocks of |cache| and |cache| itself back to the heap.
+GRD_DEDUP void grd_free_thread_cache(GrdHeapThreadCache* cache) {
+	auto heap = cache->owner;
+	for (s32 i = 0; i < GRD_HEAP_SIZE_CLASSES_COUNT; i++) {
+		auto bin = &cache->bins[i];
+		if (bin->count > 0) {
+			grd_heap_cache_release(heap, bin, i, bin->count);
+		}
+	}
+	grd_unlink_thread_cache(cache, &heap->caches, &heap->caches_mutex);
+	s32 class_idx = grd_heap_slab_of(cache)->class_idx;
+	grd_heap_central_give(heap, class_idx, cache, cache);
+}
 
-s64 map_size_to_class(u64 size) {
-	for (auto i: grd_range(BUDDY_SIZE_CLASSES_COUNT)) {
-		if (size <= BUDDY_SIZE_CLASSES[i]) {
-			return i;
+GRD_DEDUP GrdHeapThreadCache* grd_heap_thread_cache(GrdHeap* heap) {
+	return grd_get_thread_cache(heap, &heap->caches, &heap->caches_mutex, [&] {
+		// Caches live in the heap's own blocks.
+		constexpr u64 size = sizeof(GrdHeapThreadCache);
+		static_assert(size <= GRD_HEAP_MAX_SMALL_SIZE);
+		s64   taken;
+		void* block = grd_heap_central_take(heap, GRD_HEAP_CLASS_BY_SIZE.classes[(size + 15) / 16], 1, &taken);
+		return new(block) GrdHeapThreadCache();
+	});
+}
+
+GRD_DEDUP void* grd_heap_alloc_large(GrdHeap* heap, u64 size) {
+	u64 mapped_size = grd_align(sizeof(GrdHeapSlab) + size, grd_os_page_size());
+	auto slab = (GrdHeapSlab*) grd_os_map_aligned(mapped_size, GRD_HEAP_SLAB_SIZE);
+	if (!slab) {
+		grd_heap_out_of_memory(mapped_size);
+	}
+	slab->heap = heap;
+	slab->class_idx = -1;
+	slab->mapped_size = mapped_size;
+	{
+		GrdScopedLock(heap->slabs_mutex);
+		slab->next = heap->large;
+		if (heap->large) {
+			heap->large->prev = slab;
+		}
+		heap->large = slab;
+	}
+	return slab + 1;
+}
+
+GRD_DEDUP void grd_heap_free_large(GrdHeap* heap, GrdHeapSlab* slab) {
+	{
+		GrdScopedLock(heap->slabs_mutex);
+		if (slab->prev) {
+			slab->prev->next = slab->next;
+		} else {
+			heap->large = slab->next;
+		}
+		if (slab->next) {
+			slab->next->prev = slab->prev;
 		}
 	}
-	return -1;
+	grd_os_unmap(slab, slab->mapped_size);
 }
 
-void* buddy_alloc_raw(BuddyHeader* header, u64 size, s64 order) {
-	if (is_divided(header)) {
-		
+// Blocks of a class that is a multiple of 64 are aligned to 64,
+//   as are directly mapped allocations.
+GRD_DEDUP void* grd_heap_alloc(GrdHeap* heap, u64 size, u64 alignment = GRD_HEAP_ALIGNMENT) {
+	if (alignment > alignof(GrdHeapSlab)) {
+		grd_panic("GrdHeap alignment of % is larger than %", alignment, alignof(GrdHeapSlab));
+	}
+	if (size > GRD_HEAP_MAX_SMALL_SIZE) {
+		return grd_heap_alloc_large(heap, size);
+	}
+	s32  class_idx = GRD_HEAP_CLASS_BY_SIZE.classes[(size + 15) / 16];
+	if (alignment > GRD_HEAP_ALIGNMENT) {
+		while (GRD_HEAP_SIZE_CLASSES[class_idx] % alignof(GrdHeapSlab) != 0) {
+			class_idx += 1;
+			if (class_idx == GRD_HEAP_SIZE_CLASSES_COUNT) {
+				return grd_heap_alloc_large(heap, size);
+			}
+		}
+	}
+	auto cache = grd_heap_thread_cache(heap);
+	if (!cache) {
+		s64 taken;
+		return grd_heap_central_take(heap, class_idx, 1, &taken);
+	}
+	auto bin = &cache->bins[class_idx];
+	if (!bin->free_list) {
+		bin->free_list = grd_heap_central_take(heap, class_idx, grd_heap_batch_size(class_idx), &bin->count);
+	}
+	void* block = bin->free_list;
+	bin->free_list = *(void**) block;
+	bin->count -= 1;
+	return block;
+}
+
+GRD_DEDUP void grd_heap_free(GrdHeap* heap, void* ptr) {
+	auto slab = grd_heap_slab_of(ptr);
+	assert(slab->heap == heap);
+	if (slab->class_idx < 0) {
+		grd_heap_free_large(heap, slab);
+		return;
+	}
+	s32  class_idx = slab->class_idx;
+	auto cache = grd_heap_thread_cache(heap);
+	if (!cache) {
+		grd_heap_central_give(heap, class_idx, ptr, ptr);
+		return;
+	}
+	auto bin = &cache->bins[class_idx];
+	*(void**) ptr = bin->free_list;
+	bin->free_list = ptr;
+	bin->count += 1;
+	s64 batch = grd_heap_batch_size(class_idx);
+	if (bin->count > 2 * batch) {
+		grd_heap_cache_release(heap, bin, class_idx, batch);
 	}
 }
 
-void* buddy_alloc(BuddyHeader* header, u64 size, s64 order) {
-	auto class_idx = map_size_to_class(size);
-	if (class_idx != -1) {
-		
+// Bytes that may be used at |ptr|, at least the requested size.
+GRD_DEDUP u64 grd_heap_usable_size(void* ptr) {
+	auto slab = grd_heap_slab_of(ptr);
+	if (slab->class_idx < 0) {
+		return slab->mapped_size - sizeof(GrdHeapSlab);
 	}
-	return buddy_alloc_raw(header, size, order);
+	return GRD_HEAP_SIZE_CLASSES[slab->class_idx];
 }
 
-BuddyGlobalHeader* init(GrdAllocator parent, u64 size) {
-	if (size < 512 * 1024 * 1024) {
-		size = 512 * 1024 * 1024;
+GRD_DEDUP void* grd_heap_realloc(GrdHeap* heap, void* ptr, u64 new_size, u64 alignment = GRD_HEAP_ALIGNMENT) {
+	if (!ptr) {
+		return grd_heap_alloc(heap, new_size, alignment);
 	}
-	auto header = (BuddyGlobalHeader*) GrdMalloc(parent, size);
-	*header = {};
-	header->parent = parent;
-	header->size = size;
-	header->metadata_size = 4 * 1024;
+	u64 usable = grd_heap_usable_size(ptr);
+	// Don't move if it fits and doesn't waste more than a half.
+	if (new_size <= usable && new_size >= usable / 2) {
+		return ptr;
+	}
+	void* result = grd_heap_alloc(heap, new_size, alignment);
+	memcpy(result, ptr, grd_min_u64(usable, new_size));
+	grd_heap_free(heap, ptr);
+	return result;
+}
+
+GRD_DEDUP GrdHeap* grd_make_heap() {
+	auto heap = (GrdHeap*) grd_os_map(sizeof(GrdHeap));
+	if (!heap) {
+		grd_heap_out_of_memory(sizeof(GrdHeap));
+	}
+	new(heap) GrdHeap();
+	for (auto& bin: heap->bins) {
+		grd_make_mutex(&bin.mutex);
+	}
+	grd_make_mutex(&heap->slabs_mutex);
+	grd_make_mutex(&heap->caches_mutex);
+	return heap;
+}
+
+// Threads that used the heap, except the calling one, must have exited.
+GRD_DEDUP void grd_free_heap(GrdHeap* heap) {
+	grd_forget_thread_cache<GrdHeapThreadCache>(heap);
+	// The calling thread's cache is at most one left, it lives in the slabs.
+	assert(!heap->caches || !heap->caches->next_in_owner);
+
+	while (heap->large) {
+		grd_heap_free_large(heap, heap->large);
+	}
+	auto chunk = heap->chunks;
+	while (chunk) {
+		auto next = chunk->next_chunk;
+		grd_os_unmap(chunk, GRD_HEAP_SLAB_SIZE * GRD_HEAP_CHUNK_SLABS);
+		chunk = next;
+	}
+	for (auto& bin: heap->bins) {
+		bin.mutex.free();
+	}
+	heap->slabs_mutex.free();
+	heap->caches_mutex.free();
+	grd_os_unmap(heap, sizeof(GrdHeap));
+}
+
+GRD_DEDUP GrdAllocatorProcResult grd_heap_allocator_proc(void* allocator_data, GrdAllocatorProcParams p) {
+	auto heap = (GrdHeap*) allocator_data;
+	switch (p.verb) {
+		case GRD_ALLOCATOR_VERB_ALLOC: {
+			void* data = grd_heap_alloc(heap, p.new_size, grd_max_u64(p.alignment, GRD_HEAP_ALIGNMENT));
+			return { .data = data, .usable_size = grd_heap_usable_size(data) };
+		}
+		case GRD_ALLOCATOR_VERB_REALLOC: {
+			void* data = grd_heap_realloc(heap, p.old_data, p.new_size, grd_max_u64(p.alignment, GRD_HEAP_ALIGNMENT));
+			return { .data = data, .usable_size = grd_heap_usable_size(data) };
+		}
+		case GRD_ALLOCATOR_VERB_FREE:
+			grd_heap_free(heap, p.old_data);
+			break;
+		case GRD_ALLOCATOR_VERB_GET_TYPE:
+			return { .allocator_type = grd_reflect_type_of<GrdHeap>() };
+		case GRD_ALLOCATOR_VERB_FREE_ALLOCATOR:
+			grd_free_heap(heap);
+			break;
+	}
+	return {};
+}
+
+GRD_DEDUP GrdAllocator grd_make_heap_allocator() {
+	return {
+		.proc = grd_heap_allocator_proc,
+		.data = grd_make_heap(),
+	};
+}
+
+// Heap shared by the whole program, it's never freed.
+GRD_DEDUP GrdAllocator grd_heap_allocator() {
+	// Initialization of a static local is thread-safe.
+	static GrdHeap* heap = grd_make_heap();
+	return {
+		.proc = grd_heap_allocator_proc,
+		.data = heap,
+	};
 }
@@ -1,14 +1,19 @@
 #pragma once
 
 #include "../grd_hash_map.h"
+#include "../grd_flat_hash_map.h"
 #include "../grd_stopwatch.h"
 #include "../grd_range.h"
 #include "../grd_random.h"
 #include "../grd_array.h"
 #include "../grd_format.h"
 
+// Swap to compare map implementations.
+using SpeedTestMap = GrdHashMap<s64, s64>;
+// using SpeedTestMap = GrdFlatHashMap<s64, s64>;
+
 int main() {
-	GrdHashMap<s64, s64> map;
+	SpeedTestMap map;
 	map.capacity = 100;
 
 	GrdArray<s64> keys;
@@ -16,8 +21,8 @@ int main() {
 
 	s64 COUNT = 1000000;
 	for (auto i: grd_range(COUNT)) {
-		grd_add(&keys, rand_s64());
-		grd_add(&values, rand_s64());
+		grd_add(&keys, grd_rand_s64());
+		grd_add(&values, grd_rand_s64());
 	}
 
 	GrdStopwatch w = grd_make_stopwatch();
@@ -39,5 +44,20 @@ int main() {
 	time = grd_nanos_elapsed_s64(&w);
 	grd_println("Avg lookup time: % ns", f64(time) / f64(COUNT));
 
+	if constexpr (std::is_same_v<SpeedTestMap, GrdHashMap<s64, s64>>) {
+		GrdArray<s64*> out_values;
+		grd_reserve(&out_values, COUNT);
+		grd_reset(&w);
+		grd_get_many(&map, keys, out_values);
+		time = grd_nanos_elapsed_s64(&w);
+		grd_println("Avg batched lookup time: % ns", f64(time) / f64(COUNT));
+
+		SpeedTestMap batch_map;
+		grd_reset(&w);
+		grd_put_many(&batch_map, keys, values);
+		time = grd_nanos_elapsed_s64(&w);
+		grd_println("Avg batched insert time: % ns", f64(time) / f64(COUNT));
+	}
+
 	return 0;
 }
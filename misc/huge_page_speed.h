@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../grd_huge_page_allocator.h"
+#include "../grd_hash_map.h"
+#include "../grd_stopwatch.h"
+#include "../grd_range.h"
+#include "../grd_random.h"
+#include "../grd_array.h"
+#include "../grd_format.h"
+
+// Random probing of a table much larger than the TLB reach of regular pages,
+//   with regular pages and with huge pages, and appending to a large array.
+
+const char* huge_page_kind_name(GrdHugePageKind kind) {
+	switch (kind) {
+		case GrdHugePageKind::None:        return "regular pages";
+		case GrdHugePageKind::Explicit:    return "explicit huge pages";
+		case GrdHugePageKind::Transparent: return "transparent huge pages";
+	}
+	return "";
+}
+
+void huge_page_speed_probe(const char* name, GrdAllocator allocator, GrdSpan<s64> keys) {
+	s64 COUNT = grd_len(keys);
+	GrdHashMap<s64, s64> map = { .allocator = allocator };
+	grd_defer_x(map.free());
+	for (auto i: grd_range(COUNT)) {
+		grd_put(&map, keys[i], i);
+	}
+
+	// Array of 1 GiB probed at random.
+	GrdArray<u64> table = { .allocator = allocator };
+	grd_defer_x(table.free());
+	s64 TABLE_COUNT = 128 * 1024 * 1024;
+	grd_reserve(&table, TABLE_COUNT);
+	for (auto i: grd_range(TABLE_COUNT)) {
+		table[i] = u64(i);
+	}
+
+	GrdStopwatch w = grd_make_stopwatch();
+	s64 sum = 0;
+	for (auto i: grd_range(COUNT)) {
+		sum += *grd_get(&map, keys[i]);
+	}
+	f64 map_time = grd_seconds_elapsed_f64(&w);
+
+	grd_reset(&w);
+	u64 x = 1;
+	for (auto i: grd_range(COUNT)) {
+		// Dependent loads, so misses aren't overlapped.
+		x = table[(x * 0x9E3779B97F4A7C15 + u64(i)) % TABLE_COUNT];
+	}
+	f64 table_time = grd_seconds_elapsed_f64(&w);
+
+	auto kind = grd_get_huge_page_allocator(allocator) ? grd_huge_page_kind(table.data) : GrdHugePageKind::None;
+	grd_println("%, %: (checksum % %)", grd_make_string(name), grd_make_string(huge_page_kind_name(kind)), sum, x);
+	grd_println("  Avg hash map lookup time: % ns", map_time * 1e9 / f64(COUNT));
+	grd_println("  Avg table probe time: % ns", table_time * 1e9 / f64(COUNT));
+}
+
+// Growth copies with c_allocator unless the CRT remaps it,
+//   GrdHugePageAllocator always remaps.
+void huge_page_speed_append(const char* name, GrdAllocator allocator) {
+	s64 COUNT = 64 * 1024 * 1024;
+	GrdArray<s64> arr = { .allocator = allocator };
+	grd_defer_x(arr.free());
+	GrdStopwatch w = grd_make_stopwatch();
+	for (auto i: grd_range(COUNT)) {
+		grd_add(&arr, i);
+	}
+	f64 time = grd_seconds_elapsed_f64(&w);
+	grd_println("%: avg append time: % ns", grd_make_string(name), time * 1e9 / f64(COUNT));
+}
+
+int main() {
+	s64 COUNT = 16 * 1024 * 1024;
+	GrdArray<s64> keys;
+	for (auto i: grd_range(COUNT)) {
+		grd_add(&keys, grd_rand_s64());
+	}
+
+	huge_page_speed_probe("c_allocator", c_allocator, keys);
+
+	auto allocator = grd_make_huge_page_allocator();
+	huge_page_speed_probe("huge_page_allocator", allocator, keys);
+
+	huge_page_speed_append("c_allocator", c_allocator);
+	huge_page_speed_append("huge_page_allocator", allocator);
+	grd_free_allocator(allocator);
+	return 0;
+}
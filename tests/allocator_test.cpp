@@ -0,0 +1,82 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_arena_allocator.h"
+#include "../grd_tracker_allocator.h"
+#include "../grd_sub_allocator.h"
+#include "../grd_array.h"
+#include "../misc/grd_heap_allocator.h"
+
+struct alignas(64) AllocatorTestLine {
+	u8 bytes[64];
+};
+
+GRD_TEST_CASE(aligned_alloc) {
+	GrdAllocator allocators[] = {
+		c_allocator,
+		grd_make_arena_allocator(c_allocator, 4096),
+		grd_make_virtual_arena_allocator(64 * 1024 * 1024),
+		grd_make_heap_allocator(),
+		grd_make_tracker_allocator(c_allocator),
+		// Frees its parent with itself.
+		grd_make_sub_allocator(grd_make_heap_allocator()),
+	};
+	bool aligned = true;
+	bool intact = true;
+	for (auto allocator: allocators) {
+		for (u64 alignment: { 1, 8, 16, 32, 64 }) {
+			GrdMalloc(allocator, 3);
+			u64 usable;
+			auto a = (u8*) GrdMallocAligned(allocator, 100, alignment, &usable);
+			aligned = aligned && grd_is_aligned(a, alignment) && usable >= 100;
+			memset(a, 5, 100);
+			GrdMalloc(allocator, 5);
+			a = (u8*) GrdReallocAligned(allocator, a, 100, 5000, alignment, &usable);
+			aligned = aligned && grd_is_aligned(a, alignment) && usable >= 5000;
+			intact = intact && a[99] == 5;
+			GrdFree(allocator, a);
+		}
+	}
+	GRD_EXPECT(aligned);
+	GRD_EXPECT(intact);
+
+	auto lines = GrdAlloc<AllocatorTestLine>(c_allocator, 3);
+	GRD_EXPECT(grd_is_aligned(lines, 64));
+	GrdFree(lines);
+
+	for (auto allocator: allocators) {
+		if (allocator != c_allocator) {
+			grd_free_allocator(allocator);
+		}
+	}
+}
+
+// Hands out blocks rounded up to 256 bytes.
+GrdAllocatorProcResult allocator_test_rounding_proc(void* allocator_data, GrdAllocatorProcParams p) {
+	if (p.verb == GRD_ALLOCATOR_VERB_ALLOC || p.verb == GRD_ALLOCATOR_VERB_REALLOC) {
+		p.new_size = grd_align(p.new_size, 256);
+		*(s64*) allocator_data += 1;
+		auto result = c_allocator.proc(c_allocator.data, p);
+		result.usable_size = p.new_size;
+		return result;
+	}
+	return c_allocator.proc(c_allocator.data, p);
+}
+
+GRD_TEST_CASE(array_adopts_usable_size) {
+	s64 allocations = 0;
+	GrdArray<s32> arr = { .allocator = { .proc = allocator_test_rounding_proc, .data = &allocations } };
+	grd_add(&arr, 1);
+	GRD_EXPECT_EQ(arr.capacity, 64);
+	for (auto i: grd_range(63)) {
+		grd_add(&arr, i);
+	}
+	GRD_EXPECT_EQ(allocations, 1);
+	grd_add(&arr, 64);
+	GRD_EXPECT_EQ(allocations, 2);
+	GRD_EXPECT_EQ(arr.capacity, 128);
+	GRD_EXPECT_EQ(arr[63], 62);
+	arr.free();
+}
@@ -0,0 +1,136 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_arena_allocator.h"
+#include "../grd_array.h"
+
+GRD_TEST_CASE(linked_arenas_chain) {
+	auto allocator = grd_make_arena_allocator(256);
+	grd_defer_x(grd_free_allocator(allocator));
+	auto arenas = (GrdLinkedArenas*) allocator.data;
+
+	auto a = (u8*) GrdMalloc(allocator, 200);
+	auto b = (u8*) GrdMalloc(allocator, 200);
+	auto c = (u8*) GrdMalloc(allocator, 1000);
+	memset(a, 1, 200);
+	memset(b, 2, 200);
+	memset(c, 3, 1000);
+	GRD_EXPECT(arenas->first.next != NULL);
+	GRD_EXPECT(arenas->first.next->next != NULL);
+	GRD_EXPECT_EQ(arenas->current_index, 2);
+	GRD_EXPECT_EQ(a[199], 1);
+	GRD_EXPECT_EQ(b[199], 2);
+}
+
+GRD_TEST_CASE(linked_arenas_snapshot) {
+	auto allocator = grd_make_arena_allocator(256);
+	grd_defer_x(grd_free_allocator(allocator));
+
+	GrdMalloc(allocator, 100);
+	auto snapshot = grd_snapshot(allocator);
+	auto a = GrdMalloc(allocator, 100);
+	GrdMalloc(allocator, 200);
+	GrdMalloc(allocator, 200);
+	grd_restore(allocator, snapshot);
+	auto again = GrdMalloc(allocator, 100);
+	GRD_EXPECT_EQ(again, a);
+	// Arenas made before the restore are reused.
+	auto arenas = (GrdLinkedArenas*) allocator.data;
+	auto second = arenas->first.next;
+	GrdMalloc(allocator, 200);
+	GRD_EXPECT_EQ(arenas->current, second);
+}
+
+GRD_TEST_CASE(virtual_arena) {
+	auto allocator = grd_make_virtual_arena_allocator(64 * 1024 * 1024, true);
+	grd_defer_x(grd_free_allocator(allocator));
+	auto arena = (GrdVirtualArena*) allocator.data;
+
+	auto a = (u8*) GrdMalloc(allocator, 3);
+	auto b = (u8*) GrdMalloc(allocator, 5);
+	GRD_EXPECT(grd_is_aligned(a, GRD_VIRTUAL_ARENA_ALIGNMENT));
+	GRD_EXPECT(grd_is_aligned(b, GRD_VIRTUAL_ARENA_ALIGNMENT));
+	GRD_EXPECT(b > a);
+
+	auto snapshot = grd_snapshot(allocator);
+	auto big = (u8*) GrdMalloc(allocator, 10 * 1024 * 1024);
+	memset(big, 0xab, 10 * 1024 * 1024);
+	GRD_EXPECT(arena->committed >= 10 * 1024 * 1024);
+	b = (u8*) GrdRealloc(allocator, b, 5, 100);
+	GRD_EXPECT(b > big);
+
+	grd_restore(allocator, snapshot);
+	GRD_EXPECT(arena->committed <= 2 * GRD_VIRTUAL_ARENA_COMMIT_STEP);
+	auto again = (u8*) GrdMalloc(allocator, 10 * 1024 * 1024);
+	GRD_EXPECT_EQ(again, big);
+	// Decommitted pages come back zeroed.
+	GRD_EXPECT_EQ(again[5 * 1024 * 1024], 0);
+}
+
+GRD_TEST_CASE(arena_realloc_in_place) {
+	for (auto allocator: { grd_make_arena_allocator(4096), grd_make_virtual_arena_allocator(64 * 1024 * 1024) }) {
+		auto a = (u8*) GrdMalloc(allocator, 16);
+		memset(a, 7, 16);
+		auto b = (u8*) GrdRealloc(allocator, a, 16, 1000);
+		GRD_EXPECT_EQ(b, a);
+		GRD_EXPECT_EQ(b[15], 7);
+		// Not the last allocation anymore, so it's copied.
+		auto c = GrdMalloc(allocator, 8);
+		auto d = (u8*) GrdRealloc(allocator, b, 1000, 2000);
+		GRD_EXPECT(d != b && d > (u8*) c);
+		GRD_EXPECT_EQ(d[15], 7);
+		grd_free_allocator(allocator);
+	}
+}
+
+GRD_TEST_CASE(arena_array_grows_in_place) {
+	auto allocator = grd_make_virtual_arena_allocator(64 * 1024 * 1024);
+	grd_defer_x(grd_free_allocator(allocator));
+	auto arena = (GrdVirtualArena*) allocator.data;
+
+	u64 before = arena->allocated;
+	GrdArray<s64> arr = { .allocator = allocator };
+	for (auto i: grd_range(100'000)) {
+		grd_add(&arr, i);
+	}
+	GRD_EXPECT_EQ(arr[99'999], 99'999);
+	// No dead copies are left behind.
+	GRD_EXPECT(arena->allocated - before <= arr.capacity * sizeof(s64) + GRD_VIRTUAL_ARENA_ALIGNMENT);
+}
+
+GrdSpan<s64> arena_test_squares(GrdAllocator result_allocator, s64 count) {
+	GrdScratchScope scratch(result_allocator);
+	GrdArray<s64> tmp = { .allocator = scratch.allocator };
+	for (auto i: grd_range(count)) {
+		grd_add(&tmp, i * i);
+	}
+	auto result = GrdAlloc<s64>(result_allocator, count);
+	memcpy(result, tmp.data, count * sizeof(s64));
+	return { result, count };
+}
+
+GRD_TEST_CASE(scratch_scope) {
+	u8* first = NULL;
+	{
+		GrdScratchScope scratch;
+		first = (u8*) GrdMalloc(scratch.allocator, 100);
+		GrdScratchScope nested;
+		GRD_EXPECT_EQ(nested.allocator.data, scratch.allocator.data);
+		GRD_EXPECT((u8*) GrdMalloc(nested.allocator, 100) > first);
+	}
+	{
+		// Released at the end of the previous scope.
+		GrdScratchScope scratch;
+		auto again = (u8*) GrdMalloc(scratch.allocator, 100);
+		GRD_EXPECT_EQ(again, first);
+
+		// Temporaries of the callee go to the other scratch arena.
+		auto squares = arena_test_squares(scratch.allocator, 1000);
+		GRD_EXPECT_EQ(squares[999], 999 * 999);
+		auto arena = (GrdVirtualArena*) scratch.allocator.data;
+		GRD_EXPECT(arena->allocated < 200 + 1000 * sizeof(s64) + 3 * GRD_VIRTUAL_ARENA_ALIGNMENT + sizeof(GrdVirtualArena));
+	}
+	GRD_EXPECT(grd_get_scratch().data != grd_get_scratch(grd_get_scratch()).data);
+}
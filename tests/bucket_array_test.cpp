@@ -0,0 +1,48 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_bucket_array.h"
+#include "../grd_defer.h"
+#include "../grd_format.h"
+
+struct BucketArrayTestItem {
+	s64 value = 0;
+	s64 square = 0;
+};
+
+GRD_TEST_CASE(bucket_array_stable_addresses) {
+	GrdBucketArray<BucketArrayTestItem, 16> arr;
+	grd_defer_x(arr.free());
+
+	BucketArrayTestItem* first = grd_add(&arr, { 0, 0 });
+	BucketArrayTestItem* ptrs[1000];
+	ptrs[0] = first;
+	for (s64 i = 1; i < 1000; i++) {
+		ptrs[i] = grd_add(&arr, { i, i * i });
+	}
+	GRD_EXPECT_EQ(grd_len(arr), 1000);
+	GRD_EXPECT_EQ(grd_len(arr.buckets), 1000 / 16 + 1);
+
+	bool stable = true;
+	for (auto i: grd_range(1000)) {
+		stable = stable && &arr[i] == ptrs[i] && ptrs[i]->square == i * i;
+	}
+	GRD_EXPECT(stable);
+	GRD_EXPECT_EQ(arr[-1].value, 999);
+	// Items of a bucket are contiguous.
+	GRD_EXPECT_EQ(&arr[15], &arr[0] + 15);
+
+	s64 sum = 0;
+	for (auto& it: arr) {
+		sum += it.value;
+	}
+	GRD_EXPECT_EQ(sum, 999 * 1000 / 2);
+
+	// Buckets are reused after clear.
+	grd_clear(&arr);
+	auto again = grd_add(&arr, { 5, 25 });
+	GRD_EXPECT_EQ(again, first);
+	GRD_EXPECT_EQ(grd_len(arr.buckets), 1000 / 16 + 1);
+}
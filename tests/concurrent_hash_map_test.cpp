@@ -0,0 +1,57 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_concurrent_hash_map.h"
+#include "../grd_tuple.h"
+#include "../thread/grd_thread.h"
+#include "../grd_format.h"
+
+GRD_TEST_CASE(concurrent_hash_map_threads) {
+	GrdConcurrentHashMap<s64, s64> map;
+	grd_make_concurrent_hash_map(&map);
+	grd_defer_x(map.free());
+
+	constexpr s64 THREADS = 4;
+	constexpr s64 PER_THREAD = 5000;
+
+	auto proc = +[](GrdConcurrentHashMap<s64, s64>* map, s64 thread_idx) {
+		for (auto i: grd_range(PER_THREAD)) {
+			grd_put(map, thread_idx * PER_THREAD + i, i);
+			// Every thread bumps the same shared counters.
+			grd_upsert(map, -1 - (i % 16), [](s64* v, bool inserted) {
+				*v += 1;
+			});
+		}
+	};
+
+	GrdThread threads[THREADS];
+	for (auto i: grd_range(THREADS)) {
+		threads[i] = grd_start_thread(proc, &map, i);
+	}
+	for (auto& it: threads) {
+		it.join();
+	}
+
+	GRD_EXPECT_EQ(grd_len(&map), THREADS * PER_THREAD + 16);
+
+	s64 counters_total = 0;
+	for (auto i: grd_range(16)) {
+		s64 v = 0;
+		GRD_EXPECT(grd_get(&map, -1 - i, &v));
+		counters_total += v;
+	}
+	GRD_EXPECT_EQ(counters_total, THREADS * PER_THREAD);
+
+	GRD_EXPECT_EQ(grd_get_or_insert(&map, 0, 123), 0);
+	GRD_EXPECT_EQ(grd_get_or_insert(&map, s64_max, 123), 123);
+
+	s64 removed = 0;
+	GRD_EXPECT(grd_remove(&map, 1, &removed));
+	GRD_EXPECT_EQ(removed, 1);
+	GRD_EXPECT(!grd_contains(&map, 1));
+	GRD_EXPECT(grd_update(&map, 2, [](s64* v) { *v = 100; }));
+	GRD_EXPECT(!grd_update(&map, 1, [](s64* v) { *v = 100; }));
+	GRD_EXPECT(grd_get(&map, 2, &removed) && removed == 100);
+}
@@ -0,0 +1,73 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_flat_hash_map.h"
+#include "../grd_format.h"
+
+GRD_TEST_CASE(flat_hash_map_put_get) {
+	GrdFlatHashMap<s64, s64> map;
+	grd_defer_x(map.free());
+
+	for (auto i: grd_range(10000)) {
+		grd_put(&map, i, i * 3);
+	}
+	GRD_EXPECT_EQ(grd_len(map), 10000);
+	GRD_EXPECT(grd_is_power_of_two(map.capacity));
+
+	bool all_found = true;
+	for (auto i: grd_range(10000)) {
+		auto v = grd_get(&map, i);
+		if (!v || *v != i * 3) {
+			all_found = false;
+		}
+	}
+	GRD_EXPECT(all_found);
+	GRD_EXPECT(grd_get(&map, 10000) == NULL);
+
+	grd_put(&map, 5, 1);
+	GRD_EXPECT_EQ(*grd_get(&map, 5), 1);
+	GRD_EXPECT_EQ(grd_len(map), 10000);
+}
+
+GRD_TEST_CASE(flat_hash_map_remove) {
+	GrdFlatHashMap<s64, s64> map;
+	grd_defer_x(map.free());
+
+	for (auto round: grd_range(4)) {
+		for (auto i: grd_range(1000)) {
+			grd_put(&map, i, i);
+		}
+		for (auto i: grd_range(0, 1000)) {
+			if (i % 3 != 0) {
+				s64 removed = -1;
+				GRD_EXPECT(grd_remove(&map, i, &removed));
+				GRD_EXPECT_EQ(removed, i);
+			}
+		}
+		GRD_EXPECT(!grd_remove(&map, 1));
+	}
+	GRD_EXPECT_EQ(grd_len(map), 334);
+
+	s64 iterated = 0;
+	for (auto e: map.iterate()) {
+		GRD_EXPECT_EQ(e->key % 3, 0);
+		iterated += 1;
+	}
+	GRD_EXPECT_EQ(iterated, 334);
+}
+
+GRD_TEST_CASE(flat_hash_map_reflect) {
+	GrdFlatHashMap<s32, s32> map;
+	grd_defer_x(map.free());
+	grd_put(&map, 1, 2);
+	auto type = grd_reflect_type_of<GrdFlatHashMap<s32, s32>>();
+	GRD_EXPECT_EQ(type->kind, GrdMapType::KIND);
+	auto map_type = (GrdMapType*) type;
+	GRD_EXPECT_EQ(map_type->get_count(&map), 1);
+	for (auto it: map_type->iterate(&map)) {
+		GRD_EXPECT_EQ(*(s32*) it->key, 1);
+		GRD_EXPECT_EQ(*(s32*) it->value, 2);
+	}
+}
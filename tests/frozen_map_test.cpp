@@ -0,0 +1,70 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_frozen_map.h"
+#include "../grd_string.h"
+#include "../grd_format.h"
+
+GRD_DEDUP constexpr auto FROZEN_INT_MAP = grd_make_frozen_map<s32, s32>({
+	{ 10, 100 },
+	{ 20, 200 },
+	{ 30, 300 },
+	{ -1, 0 },
+});
+
+static_assert(*grd_get(&FROZEN_INT_MAP, 20) == 200);
+static_assert(!grd_contains(&FROZEN_INT_MAP, 40));
+
+GRD_DEDUP constinit auto FROZEN_STRING_MAP = grd_make_frozen_map<GrdString, s32>({
+	{ "zero"_b,  0 },
+	{ "one"_b,   1 },
+	{ "two"_b,   2 },
+	{ "three"_b, 3 },
+	{ "four"_b,  4 },
+	{ "five"_b,  5 },
+	{ "six"_b,   6 },
+	{ "seven"_b, 7 },
+	{ "eight"_b, 8 },
+	{ "nine"_b,  9 },
+	{ ""_b,      -1 },
+});
+
+GRD_TEST_CASE(frozen_map_string_keys) {
+	GRD_EXPECT_EQ(grd_len(FROZEN_STRING_MAP), 11);
+	for (auto i: grd_range(grd_len(FROZEN_STRING_MAP))) {
+		auto key = FROZEN_STRING_MAP.keys[i];
+		auto value = grd_get(&FROZEN_STRING_MAP, key);
+		GRD_EXPECT(value);
+		GRD_EXPECT_EQ(*value, FROZEN_STRING_MAP.values[i]);
+	}
+	GRD_EXPECT_EQ(*grd_get(&FROZEN_STRING_MAP, "seven"_b), 7);
+	GRD_EXPECT_EQ(*grd_get(&FROZEN_STRING_MAP, ""_b), -1);
+	GRD_EXPECT(!grd_get(&FROZEN_STRING_MAP, "ten"_b));
+	GRD_EXPECT(!grd_get(&FROZEN_STRING_MAP, "sevenn"_b));
+
+	// Values are mutable, keys are not.
+	*grd_get(&FROZEN_STRING_MAP, "one"_b) = 11;
+	GRD_EXPECT_EQ(*grd_get(&FROZEN_STRING_MAP, "one"_b), 11);
+}
+
+struct FrozenMapTestOp {
+	GrdUnicodeString op;
+	s32              prec;
+};
+
+GRD_DEDUP constinit auto FROZEN_OP_MAP = grd_make_frozen_map<GrdUnicodeString, FrozenMapTestOp>({
+		{ U"+"_b,   1 },
+		{ U"+="_b,  2 },
+		{ U"<<="_b, 3 },
+		{ U"<<"_b,  4 },
+	},
+	[](FrozenMapTestOp x) { return x.op; }
+);
+
+GRD_TEST_CASE(frozen_map_key_of_value) {
+	GRD_EXPECT_EQ(grd_get(&FROZEN_OP_MAP, U"<<="_b)->prec, 3);
+	GRD_EXPECT_EQ(grd_get(&FROZEN_OP_MAP, U"+"_b)->prec, 1);
+	GRD_EXPECT(!grd_get(&FROZEN_OP_MAP, U"-"_b));
+}
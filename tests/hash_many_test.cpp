@@ -0,0 +1,76 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_hash_many.h"
+#include "../grd_format.h"
+
+template <typename T>
+bool hash_many_test_matches_scalar(s64 count) {
+	T          keys[67];
+	GrdHash64  hashes[67];
+	assert(count <= grd_static_array_count(keys));
+	u8* bytes = (u8*) keys;
+	for (auto i: grd_range(sizeof(keys))) {
+		bytes[i] = u8(i * 131 + 7);
+	}
+	grd_hash64_many(GrdSpan<T>{ keys, count }, GrdSpan<GrdHash64>{ hashes, count });
+	for (auto i: grd_range(count)) {
+		if (hashes[i] != grd_hash64(keys[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+GRD_TEST_CASE(hash_many_matches_scalar) {
+	for (s64 count: { 0, 1, 3, 4, 5, 8, 67 }) {
+		GRD_EXPECT(hash_many_test_matches_scalar<u8>(count));
+		GRD_EXPECT(hash_many_test_matches_scalar<u16>(count));
+		GRD_EXPECT(hash_many_test_matches_scalar<u32>(count));
+		GRD_EXPECT(hash_many_test_matches_scalar<u64>(count));
+		GRD_EXPECT(hash_many_test_matches_scalar<s32>(count));
+		GRD_EXPECT(hash_many_test_matches_scalar<void*>(count));
+	}
+}
+
+#if GRD_HASH_MANY_SIMD
+template <u64 size>
+bool hash_many_test_lanes_match_scalar() {
+	constexpr s64 count = 4 * GRD_HASH_MANY_LANES;
+	u8         keys[count * size];
+	GrdHash64  hashes[count];
+	for (auto i: grd_range(sizeof(keys))) {
+		keys[i] = u8(i * 131 + 7);
+	}
+	s64 done = grd_hash64_many_simd<size>(keys, count, hashes);
+	if (done != count) {
+		return false;
+	}
+	for (auto i: grd_range(count)) {
+		if (hashes[i] != grd_hash64(keys + i * size, size)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Every branch of SpookyHash's short path.
+GRD_TEST_CASE(hash_many_lanes_sizes) {
+	if (!grd_hash_many_has_simd()) {
+		return;
+	}
+	GRD_EXPECT(hash_many_test_lanes_match_scalar<1>());
+	GRD_EXPECT(hash_many_test_lanes_match_scalar<7>());
+	GRD_EXPECT(hash_many_test_lanes_match_scalar<12>());
+	GRD_EXPECT(hash_many_test_lanes_match_scalar<15>());
+	GRD_EXPECT(hash_many_test_lanes_match_scalar<16>());
+	GRD_EXPECT(hash_many_test_lanes_match_scalar<24>());
+	GRD_EXPECT(hash_many_test_lanes_match_scalar<32>());
+	GRD_EXPECT(hash_many_test_lanes_match_scalar<40>());
+	GRD_EXPECT(hash_many_test_lanes_match_scalar<53>());
+	GRD_EXPECT(hash_many_test_lanes_match_scalar<100>());
+	GRD_EXPECT(hash_many_test_lanes_match_scalar<191>());
+}
+#endif
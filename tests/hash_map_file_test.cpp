@@ -0,0 +1,106 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_hash_map_file.h"
+#include "../grd_format.h"
+#include <stdio.h>
+
+struct HashMapFileTestValue {
+	s64 a;
+	f32 b;
+};
+
+template <GrdHashMapLayout L>
+void hash_map_file_test_round_trip() {
+	auto path = U"hash_map_file_test.bin"_b;
+	GrdHashMap<s64, HashMapFileTestValue, L> map;
+	grd_defer_x(map.free());
+	for (auto i: grd_range(10000)) {
+		grd_put(&map, i * 7, HashMapFileTestValue { i, f32(i) / 2 });
+	}
+	GRD_EXPECT(!grd_write_hash_map(path, &map));
+
+	auto [mapped, e] = grd_map_hash_map_file<s64, HashMapFileTestValue, L>(path);
+	GRD_EXPECT(!e);
+	grd_defer_x(mapped.free());
+	GRD_EXPECT_EQ(grd_len(mapped), 10000);
+
+	bool all_found = true;
+	for (auto i: grd_range(10000)) {
+		auto v = grd_get(&mapped, i * 7);
+		if (!v || v->a != i || v->b != f32(i) / 2) {
+			all_found = false;
+		}
+	}
+	GRD_EXPECT(all_found);
+	GRD_EXPECT(!grd_contains(&mapped, 1));
+
+	// Batched lookups run on the mapped storage too.
+	s64 keys[] = { 0, 7, 8 };
+	HashMapFileTestValue* values[3];
+	GRD_EXPECT_EQ(grd_get_many(&mapped.map, GrdSpan<s64>{ keys, 3 }, GrdSpan<HashMapFileTestValue*>{ values, 3 }), 2);
+	remove("hash_map_file_test.bin");
+}
+
+GRD_TEST_CASE(hash_map_file_entries_layout) {
+	hash_map_file_test_round_trip<GRD_HASH_MAP_LAYOUT_ENTRIES>();
+}
+
+GRD_TEST_CASE(hash_map_file_split_layout) {
+	hash_map_file_test_round_trip<GRD_HASH_MAP_LAYOUT_SPLIT>();
+}
+
+GRD_TEST_CASE(hash_map_file_empty_and_mismatch) {
+	auto path = U"hash_map_file_test_empty.bin"_b;
+	GrdHashMap<s32, s32> map;
+	GRD_EXPECT(!grd_write_hash_map(path, &map));
+
+	auto [mapped, e] = grd_map_hash_map_file<s32, s32>(path);
+	GRD_EXPECT(!e);
+	GRD_EXPECT_EQ(grd_len(mapped), 0);
+	GRD_EXPECT(!grd_get(&mapped, 1));
+	mapped.free();
+
+	auto [wrong, e2] = grd_map_hash_map_file<s32, s64>(path);
+	GRD_EXPECT(e2);
+	auto [wrong_layout, e3] = grd_map_hash_map_file<s32, s32, GRD_HASH_MAP_LAYOUT_SPLIT>(path);
+	GRD_EXPECT(e3);
+	remove("hash_map_file_test_empty.bin");
+}
+
+GRD_TEST_CASE(hash_map_file_corrupt_header) {
+	auto path = U"hash_map_file_test_corrupt.bin"_b;
+	GrdHashMap<s32, s32> map;
+	grd_defer_x(map.free());
+	for (auto i: grd_range(100)) {
+		grd_put(&map, i, i);
+	}
+	GrdHashMapFileHeader header = grd_hash_map_file_header<s32, s32, GRD_HASH_MAP_LAYOUT_ENTRIES>(map.capacity, map.count);
+
+	auto corrupt_and_map = [&](GrdHashMapFileHeader corrupt) {
+		GRD_EXPECT(!grd_write_hash_map(path, &map));
+		FILE* file = fopen("hash_map_file_test_corrupt.bin", "r+b");
+		fwrite(&corrupt, sizeof(corrupt), 1, file);
+		fclose(file);
+		auto [mapped, e] = grd_map_hash_map_file<s32, s32>(path);
+		if (e) {
+			return true;
+		}
+		mapped.free();
+		return false;
+	};
+
+	auto count_too_big = header;
+	count_too_big.count = header.capacity + 1;
+	GRD_EXPECT(corrupt_and_map(count_too_big));
+
+	// Storage size of this capacity overflows.
+	auto capacity_too_big = header;
+	capacity_too_big.capacity = s64(1) << 62;
+	GRD_EXPECT(corrupt_and_map(capacity_too_big));
+
+	GRD_EXPECT(!corrupt_and_map(header));
+	remove("hash_map_file_test_corrupt.bin");
+}
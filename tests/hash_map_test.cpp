@@ -0,0 +1,208 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_hash_map.h"
+#include "../grd_array.h"
+#include "../grd_string.h"
+#include "../grd_format.h"
+
+struct HashMapTestValue {
+	s64 a[8];
+};
+
+template <GrdHashMapLayout L>
+void hash_map_test_put_get_remove() {
+	GrdHashMap<s64, HashMapTestValue, L> map;
+	grd_defer_x(map.free());
+
+	for (auto i: grd_range(5000)) {
+		grd_put(&map, i, HashMapTestValue { .a = { i, i * 2 } });
+	}
+	GRD_EXPECT_EQ(grd_len(map), 5000);
+
+	bool all_found = true;
+	for (auto i: grd_range(5000)) {
+		auto v = grd_get(&map, i);
+		if (!v || v->a[0] != i || v->a[1] != i * 2) {
+			all_found = false;
+		}
+	}
+	GRD_EXPECT(all_found);
+	GRD_EXPECT(grd_get(&map, -1) == NULL);
+
+	// Removed value is the key's, even when backward shift fills its slot.
+	bool removed_values_match = true;
+	for (auto i: grd_range(5000)) {
+		if (i % 2 == 1) {
+			HashMapTestValue removed;
+			if (!grd_remove(&map, i, &removed) || removed.a[0] != i) {
+				removed_values_match = false;
+			}
+		}
+	}
+	GRD_EXPECT(removed_values_match);
+	GRD_EXPECT_EQ(grd_len(map), 2500);
+
+	s64 iterated = 0;
+	bool all_even = true;
+	for (auto e: map.iterate()) {
+		if (e->key % 2 != 0 || e->value.a[0] != e->key) {
+			all_even = false;
+		}
+		iterated += 1;
+	}
+	GRD_EXPECT(all_even);
+	GRD_EXPECT_EQ(iterated, 2500);
+}
+
+GRD_TEST_CASE(hash_map_entries_layout) {
+	hash_map_test_put_get_remove<GRD_HASH_MAP_LAYOUT_ENTRIES>();
+}
+
+GRD_TEST_CASE(hash_map_split_layout) {
+	hash_map_test_put_get_remove<GRD_HASH_MAP_LAYOUT_SPLIT>();
+}
+
+GRD_TEST_CASE(hash_map_split_layout_reflect) {
+	GrdHashMap<s32, s32, GRD_HASH_MAP_LAYOUT_SPLIT> map;
+	grd_defer_x(map.free());
+	grd_put(&map, 1, 2);
+	auto type = (GrdHashMapType*) grd_reflect_type_of<decltype(map)>();
+	GRD_EXPECT_EQ(type->layout, GRD_HASH_MAP_LAYOUT_SPLIT);
+	GRD_EXPECT_EQ(type->get_count(&map), 1);
+	for (auto it: type->iterate(&map)) {
+		GRD_EXPECT_EQ(*(s32*) it->key, 1);
+		GRD_EXPECT_EQ(*(s32*) it->value, 2);
+	}
+}
+
+GRD_TEST_CASE(hash_map_get_put_many) {
+	GrdHashMap<s64, s64> map;
+	grd_defer_x(map.free());
+
+	GrdArray<s64> keys;
+	GrdArray<s64> values;
+	grd_defer_x(keys.free());
+	grd_defer_x(values.free());
+	for (auto i: grd_range(1000)) {
+		grd_add(&keys, i * 7);
+		grd_add(&values, i);
+	}
+	grd_put(&map, 0, -1);
+	grd_put_many(&map, keys, values);
+	GRD_EXPECT_EQ(grd_len(map), 1000);
+
+	grd_add(&keys, -5);
+	GrdArray<s64*> out;
+	grd_defer_x(out.free());
+	grd_reserve(&out, keys.count);
+	GRD_EXPECT_EQ(grd_get_many(&map, keys, out), 1000);
+
+	bool all_match = true;
+	for (auto i: grd_range(1000)) {
+		if (!out[i] || *out[i] != i) {
+			all_match = false;
+		}
+	}
+	GRD_EXPECT(all_match);
+	GRD_EXPECT(out[-1] == NULL);
+}
+
+GRD_TEST_CASE(hash_map_string_keys) {
+	GrdHashMap<GrdString, s64> map;
+	grd_defer_x(map.free());
+
+	// Covers every branch of grd_hash64_fast().
+	char long_str[] = "0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz";
+	s64 long_len = grd_static_array_count(long_str) - 1;
+	for (auto len: grd_range(long_len + 1)) {
+		grd_put(&map, GrdString{ long_str, len }, len);
+	}
+	GRD_EXPECT_EQ(grd_len(map), long_len + 1);
+
+	bool all_found = true;
+	for (auto len: grd_range(long_len + 1)) {
+		// Same content at a different address must hash the same.
+		char buf[128];
+		memcpy(buf, long_str, len);
+		auto v = grd_get(&map, GrdString{ buf, len });
+		if (!v || *v != len) {
+			all_found = false;
+		}
+	}
+	GRD_EXPECT(all_found);
+}
+
+GRD_TEST_CASE(hash_map_pointer_keys) {
+	GrdHashMap<void*, s64> map;
+	grd_defer_x(map.free());
+	// Pointers with the same low bits used to be a bad case for modulo indexing.
+	for (auto i: grd_range(4096)) {
+		grd_put(&map, (void*) (i * 4096), i);
+	}
+	GRD_EXPECT(grd_is_power_of_two(map.capacity));
+	bool all_found = true;
+	for (auto i: grd_range(4096)) {
+		auto v = grd_get(&map, (void*) (i * 4096));
+		if (!v || *v != i) {
+			all_found = false;
+		}
+	}
+	GRD_EXPECT(all_found);
+}
+
+template <GrdHashMapLayout L>
+void hash_map_test_incremental_rehash() {
+	GrdHashMap<s64, s64, L> map;
+	map.incremental_rehash = true;
+	grd_defer_x(map.free());
+	// Same operations on a map that rehashes in one go.
+	GrdHashMap<s64, s64> reference;
+	grd_defer_x(reference.free());
+
+	bool saw_migration = false;
+	bool found_while_migrating = true;
+	for (auto i: grd_range(20000)) {
+		grd_put(&map, i, i * 3);
+		grd_put(&reference, i, i * 3);
+		if (i % 3 == 0) {
+			// Removes and overwrites hit both tables while migrating.
+			grd_remove(&map, i / 2);
+			grd_remove(&reference, i / 2);
+			grd_put(&map, i / 5, -i);
+			grd_put(&reference, i / 5, -i);
+		}
+		if (grd_hash_map_is_migrating(&map)) {
+			saw_migration = true;
+			auto v = grd_get(&map, i);
+			if (!v || *v != i * 3) {
+				found_while_migrating = false;
+			}
+		}
+	}
+	GRD_EXPECT(saw_migration);
+	GRD_EXPECT(found_while_migrating);
+	GRD_EXPECT_EQ(grd_len(map), grd_len(reference));
+
+	bool all_match = true;
+	for (auto e: reference.iterate()) {
+		auto v = grd_get(&map, e->key);
+		if (!v || *v != e->value) {
+			all_match = false;
+		}
+	}
+	GRD_EXPECT(all_match);
+
+	s64 iterated = 0;
+	for (auto e: map.iterate()) {
+		iterated += 1;
+	}
+	GRD_EXPECT_EQ(iterated, grd_len(reference));
+}
+
+GRD_TEST_CASE(hash_map_incremental_rehash) {
+	hash_map_test_incremental_rehash<GRD_HASH_MAP_LAYOUT_ENTRIES>();
+	hash_map_test_incremental_rehash<GRD_HASH_MAP_LAYOUT_SPLIT>();
+}
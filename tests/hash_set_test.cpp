@@ -0,0 +1,85 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_hash_set.h"
+#include "../grd_sub_allocator.h"
+#include "../grd_tracker_allocator.h"
+#include "../grd_format.h"
+
+GRD_TEST_CASE(hash_set_add_contains_remove) {
+	GrdHashSet<s64> set;
+	grd_defer_x(set.free());
+
+	GRD_EXPECT(grd_add(&set, 5));
+	GRD_EXPECT(!grd_add(&set, 5));
+	GRD_EXPECT(grd_contains(&set, 5));
+	GRD_EXPECT(!grd_contains(&set, 6));
+	GRD_EXPECT(grd_remove(&set, 5));
+	GRD_EXPECT(!grd_remove(&set, 5));
+	GRD_EXPECT_EQ(grd_len(set), 0);
+
+	for (auto i: grd_range(1000)) {
+		grd_add(&set, i);
+	}
+	s64 sum = 0;
+	for (s64* key: set.iterate()) {
+		sum += *key;
+	}
+	GRD_EXPECT_EQ(sum, 999 * 1000 / 2);
+}
+
+GRD_TEST_CASE(hash_set_entry_has_no_value) {
+	GRD_EXPECT_EQ(sizeof(GrdHashMapEntry<void*, GrdEmptyStruct>), sizeof(void*) + sizeof(GrdHash64));
+}
+
+GRD_TEST_CASE(hash_set_union_intersection_difference) {
+	GrdHashSet<s64> a;
+	GrdHashSet<s64> b;
+	grd_defer_x(a.free());
+	grd_defer_x(b.free());
+	for (auto i: grd_range(100)) {
+		grd_add(&a, i);
+		grd_add(&b, i + 50);
+	}
+
+	auto u = grd_union(&a, &b);
+	auto i = grd_intersection(&a, &b);
+	auto d = grd_difference(&a, &b);
+	grd_defer_x(u.free());
+	grd_defer_x(i.free());
+	grd_defer_x(d.free());
+
+	GRD_EXPECT_EQ(grd_len(u), 150);
+	GRD_EXPECT_EQ(grd_len(i), 50);
+	GRD_EXPECT_EQ(grd_len(d), 50);
+	GRD_EXPECT(grd_contains(&i, 50) && grd_contains(&i, 99) && !grd_contains(&i, 49));
+	GRD_EXPECT(grd_contains(&d, 0) && grd_contains(&d, 49) && !grd_contains(&d, 50));
+}
+
+GRD_TEST_CASE(hash_set_reflect) {
+	GrdHashSet<s32> set;
+	grd_defer_x(set.free());
+	grd_add(&set, 7);
+	auto type = (GrdSetType*) grd_reflect_type_of<decltype(set)>();
+	GRD_EXPECT(type->kind == GrdSetType::KIND);
+	GRD_EXPECT_EQ(type->get_count(&set), 1);
+	for (void* it: type->iterate(&set)) {
+		GRD_EXPECT_EQ(*(s32*) it, 7);
+	}
+}
+
+GRD_TEST_CASE(sub_allocator_tracks_allocations) {
+	// Sub allocator frees its parent with itself.
+	auto allocator = grd_make_sub_allocator(grd_make_tracker_allocator());
+	auto sub = (GrdSubAllocator*) allocator.data;
+	void* a = GrdMalloc(allocator, 16);
+	void* b = GrdMalloc(allocator, 16);
+	GRD_EXPECT_EQ(grd_len(sub->map), 2);
+	GrdFree(allocator, a);
+	GRD_EXPECT(!grd_contains(&sub->map, a));
+	GRD_EXPECT(grd_contains(&sub->map, b));
+	GrdFree(allocator, b);
+	grd_free_allocator(allocator);
+}
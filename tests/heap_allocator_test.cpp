@@ -0,0 +1,102 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../misc/grd_heap_allocator.h"
+#include "../grd_tuple.h"
+#include "../thread/grd_thread.h"
+
+GRD_TEST_CASE(heap_size_classes) {
+	auto heap = grd_make_heap_allocator();
+	grd_defer_x(grd_free_allocator(heap));
+
+	bool all_fit = true;
+	for (u64 size: { 0, 1, 15, 16, 17, 100, 1000, 4096, 9000, 9472, 9473, 100'000, 5'000'000 }) {
+		auto ptr = (u8*) GrdMalloc(heap, size);
+		memset(ptr, 0xab, size);
+		if (!grd_is_aligned(ptr, GRD_HEAP_ALIGNMENT) || grd_heap_usable_size(ptr) < size) {
+			all_fit = false;
+		}
+		GrdFree(heap, ptr);
+	}
+	GRD_EXPECT(all_fit);
+	GRD_EXPECT_EQ(GRD_HEAP_SIZE_CLASSES[GRD_HEAP_CLASS_BY_SIZE.classes[(17 + 15) / 16]], 32);
+	GRD_EXPECT_EQ(GRD_HEAP_SIZE_CLASSES[GRD_HEAP_CLASS_BY_SIZE.classes[(9000 + 15) / 16]], 9472);
+}
+
+GRD_TEST_CASE(heap_reuse_and_realloc) {
+	auto heap = grd_make_heap_allocator();
+	grd_defer_x(grd_free_allocator(heap));
+
+	void* a = GrdMalloc(heap, 40);
+	GrdFree(heap, a);
+	GRD_EXPECT(GrdMalloc(heap, 48) == a);
+
+	auto p = (u8*) GrdMalloc(heap, 10);
+	for (auto i: grd_range(10)) {
+		p[i] = u8(i);
+	}
+	p = (u8*) GrdRealloc(heap, p, 10, 20'000);
+	bool kept = true;
+	for (auto i: grd_range(10)) {
+		kept = kept && p[i] == i;
+	}
+	GRD_EXPECT(kept);
+	p = (u8*) GrdRealloc(heap, p, 20'000, 5);
+	GRD_EXPECT(p[4] == 4);
+	GRD_EXPECT_EQ(grd_heap_usable_size(p), 16);
+	GrdFree(heap, p);
+}
+
+GRD_TEST_CASE(heap_threads) {
+	auto heap = grd_make_heap_allocator();
+	grd_defer_x(grd_free_allocator(heap));
+
+	constexpr s64 THREADS = 4;
+	constexpr s64 COUNT = 20'000;
+	static void* shared[THREADS][COUNT];
+	static bool  ok[THREADS];
+
+	// Every thread allocates, then frees blocks allocated by its neighbour.
+	auto proc = +[](GrdAllocator heap, s64 idx) {
+		ok[idx] = true;
+		for (auto i: grd_range(COUNT)) {
+			u64 size = (i * 37) % 2000;
+			auto p = (u8*) GrdMalloc(heap, size + 1);
+			p[0] = u8(idx);
+			p[size] = u8(idx);
+			shared[idx][i] = p;
+		}
+		for (auto i: grd_range(COUNT)) {
+			auto p = (u8*) shared[idx][i];
+			ok[idx] = ok[idx] && p[0] == u8(idx);
+		}
+	};
+	GrdThread threads[THREADS];
+	for (auto i: grd_range(THREADS)) {
+		threads[i] = grd_start_thread(proc, heap, i);
+	}
+	for (auto i: grd_range(THREADS)) {
+		threads[i].join();
+	}
+	auto free_proc = +[](GrdAllocator heap, s64 idx) {
+		for (auto i: grd_range(COUNT)) {
+			GrdFree(heap, shared[(idx + 1) % THREADS][i]);
+		}
+	};
+	for (auto i: grd_range(THREADS)) {
+		threads[i] = grd_start_thread(free_proc, heap, i);
+	}
+	for (auto i: grd_range(THREADS)) {
+		threads[i].join();
+		GRD_EXPECT(ok[i]);
+	}
+	// Freed blocks are reused.
+	auto heap_data = (GrdHeap*) heap.data;
+	u8* next_slab = heap_data->next_slab;
+	for (auto i: grd_range(1000)) {
+		GrdFree(heap, GrdMalloc(heap, 64));
+	}
+	GRD_EXPECT(heap_data->next_slab == next_slab);
+}
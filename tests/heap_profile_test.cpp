@@ -0,0 +1,87 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_heap_profile.h"
+
+GRD_NO_INLINE void* heap_profile_test_alloc_a(GrdAllocator allocator) {
+	return GrdMalloc(allocator, 1000);
+}
+
+GRD_NO_INLINE void* heap_profile_test_alloc_b(GrdAllocator allocator) {
+	return GrdMalloc(allocator, 300);
+}
+
+// Sum of values in collapsed stacks and number of lines.
+GrdTuple<s64, s64> heap_profile_test_sum(GrdString collapsed) {
+	s64 total = 0;
+	s64 lines = 0;
+	for (auto i: grd_range(grd_len(collapsed))) {
+		if (collapsed[i] == '\n') {
+			s64 space = i;
+			while (collapsed[space] != ' ') {
+				space -= 1;
+			}
+			total += atoll(&collapsed[space + 1]);
+			lines += 1;
+		}
+	}
+	return { total, lines };
+}
+
+GRD_TEST_CASE(heap_profile_collapsed) {
+	auto tracker = grd_make_tracker_allocator(c_allocator, 0, 16);
+	grd_defer_x(grd_free_allocator(tracker));
+
+	void* a[10];
+	void* b[10];
+	for (auto i: grd_range(10)) {
+		a[i] = heap_profile_test_alloc_a(tracker);
+		b[i] = heap_profile_test_alloc_b(tracker);
+	}
+	for (auto i: grd_range(5)) {
+		GrdFree(tracker, a[i]);
+	}
+
+	auto live = grd_heap_profile_collapsed(tracker, GrdHeapProfileKind::Live);
+	grd_defer_x(live.free());
+	auto [live_total, live_lines] = heap_profile_test_sum(live);
+	GRD_EXPECT_EQ(live_total, 5 * 1000 + 10 * 300);
+	GRD_EXPECT_EQ(live_lines, 2);
+	bool printable = true;
+	for (auto c: live) {
+		printable = printable && (c == '\n' || (c >= ' ' && c < 127));
+	}
+	GRD_EXPECT(printable);
+
+	auto allocated = grd_heap_profile_collapsed(tracker, GrdHeapProfileKind::Allocated);
+	grd_defer_x(allocated.free());
+	auto [allocated_total, allocated_lines] = heap_profile_test_sum(allocated);
+	GRD_EXPECT_EQ(allocated_total, 10 * 1000 + 10 * 300);
+
+	for (auto i: grd_range_from_to(5, 10)) {
+		GrdFree(tracker, a[i]);
+	}
+	for (auto i: grd_range(10)) {
+		GrdFree(tracker, b[i]);
+	}
+	auto empty = grd_heap_profile_collapsed(tracker, GrdHeapProfileKind::Live);
+	grd_defer_x(empty.free());
+	GRD_EXPECT_EQ(grd_len(empty), 0);
+}
+
+GRD_TEST_CASE(heap_profile_pprof) {
+	auto tracker = grd_make_tracker_allocator(c_allocator, 0, 16);
+	grd_defer_x(grd_free_allocator(tracker));
+	void* a = heap_profile_test_alloc_a(tracker);
+	grd_defer_x(GrdFree(tracker, a));
+
+	auto profile = grd_heap_profile_pprof(tracker);
+	grd_defer_x(profile.free());
+	// First field is a sample_type message.
+	GRD_EXPECT(grd_len(profile) > 0);
+	GRD_EXPECT_EQ(profile[0], (1 << 3) | 2);
+	// Last is default_sample_type.
+	GRD_EXPECT_EQ(profile[grd_len(profile) - 2], 14 << 3);
+}
@@ -0,0 +1,115 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_huge_page_allocator.h"
+#include "../grd_array.h"
+#include "../grd_hash_map.h"
+
+GRD_TEST_CASE(huge_page_array) {
+	auto allocator = grd_make_huge_page_allocator();
+	grd_defer_x(grd_free_allocator(allocator));
+	auto hp = grd_get_huge_page_allocator(allocator);
+
+	GrdArray<s64> arr = { .allocator = allocator };
+	grd_add(&arr, 1);
+	// The whole huge page is capacity.
+	GRD_EXPECT_EQ(arr.capacity, s64((grd_os_huge_page_size() - sizeof(GrdHugePageBlock)) / sizeof(s64)));
+	GRD_EXPECT(grd_is_aligned((u8*) arr.data - sizeof(GrdHugePageBlock), grd_os_huge_page_size()));
+
+	for (auto i: grd_range(1'000'000)) {
+		grd_add(&arr, i);
+	}
+	GRD_EXPECT_EQ(arr[1'000'000], 999'999);
+	auto kind = grd_huge_page_kind(arr.data);
+	GRD_EXPECT_EQ(hp->blocks[s64(kind)], 1);
+	GRD_EXPECT(hp->bytes[s64(kind)] >= 1'000'001 * sizeof(s64));
+	arr.free();
+	GRD_EXPECT_EQ(hp->blocks[s64(kind)], 0);
+	GRD_EXPECT_EQ(hp->bytes[s64(kind)], 0);
+}
+
+GRD_TEST_CASE(huge_page_hash_map) {
+	auto allocator = grd_make_huge_page_allocator();
+	grd_defer_x(grd_free_allocator(allocator));
+
+	GrdHashMap<s64, s64> map = { .allocator = allocator };
+	for (auto i: grd_range(100'000)) {
+		grd_put(&map, i, i * 3);
+	}
+	bool found = true;
+	for (auto i: grd_range(100'000)) {
+		auto v = grd_get(&map, i);
+		found = found && v && *v == i * 3;
+	}
+	GRD_EXPECT(found);
+	map.free();
+}
+
+GRD_TEST_CASE(huge_page_remap_growth) {
+	auto allocator = grd_make_huge_page_allocator();
+	grd_defer_x(grd_free_allocator(allocator));
+	auto hp = grd_get_huge_page_allocator(allocator);
+
+	GrdArray<s64> arr = { .allocator = allocator };
+	s64 count = 16 * 1024 * 1024;
+	bool aligned = true;
+	for (auto i: grd_range(count)) {
+		grd_add(&arr, i);
+		aligned = aligned && grd_is_aligned((u8*) arr.data - sizeof(GrdHugePageBlock), grd_os_huge_page_size());
+	}
+	GRD_EXPECT(aligned);
+	bool intact = true;
+	for (auto i: grd_range(count)) {
+		intact = intact && arr[i] == i;
+	}
+	GRD_EXPECT(intact);
+	// Only the last block is left mapped.
+	s64 blocks = 0;
+	s64 bytes = 0;
+	for (auto i: grd_range(3)) {
+		blocks += hp->blocks[i];
+		bytes += hp->bytes[i];
+	}
+	GRD_EXPECT_EQ(blocks, 1);
+	GRD_EXPECT_EQ(bytes, s64(grd_huge_page_block_of(arr.data)->mapped_size));
+	arr.free();
+}
+
+GRD_TEST_CASE(os_remap) {
+	u64 page = grd_os_page_size();
+	u64 huge = grd_os_huge_page_size();
+	// The last page stays mapped right after the first three,
+	//   so they can't grow in place and are moved.
+	auto ptr = (u8*) grd_os_map_aligned(page * 4, huge);
+	memset(ptr, 9, page * 3);
+	auto moved = (u8*) grd_os_remap(ptr, page * 3, 64 * 1024 * 1024, huge);
+#if GRD_OS_LINUX
+	GRD_EXPECT(moved != NULL);
+	GRD_EXPECT(moved != ptr);
+#endif
+	if (moved) {
+		GRD_EXPECT(grd_is_aligned(moved, huge));
+		GRD_EXPECT_EQ(moved[page * 3 - 1], 9);
+		moved[64 * 1024 * 1024 - 1] = 1;
+		grd_os_unmap(moved, 64 * 1024 * 1024);
+		grd_os_unmap(ptr + page * 3, page);
+	} else {
+		grd_os_unmap(ptr, page * 4);
+	}
+
+	// Unaligned mappings are moved to an aligned range instead of growing in place.
+	auto base = (u8*) grd_os_map_aligned(huge, huge);
+	auto unaligned = base + page;
+	unaligned[0] = 3;
+	moved = (u8*) grd_os_remap(unaligned, huge - page, huge * 2, huge);
+	if (moved) {
+		GRD_EXPECT(grd_is_aligned(moved, huge));
+		GRD_EXPECT_EQ(moved[0], 3);
+		grd_os_unmap(moved, huge * 2);
+		grd_os_unmap(base, page);
+	} else {
+		grd_os_unmap(base, huge);
+	}
+}
@@ -0,0 +1,90 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_interner.h"
+#include "../grd_tuple.h"
+#include "../thread/grd_thread.h"
+#include "../grd_format.h"
+
+GRD_TEST_CASE(interner_same_string_same_atom) {
+	GrdInterner<char32_t> interner;
+	grd_make_interner(&interner);
+	grd_defer_x(interner.free());
+
+	auto a = grd_intern(&interner, U"hello"_b);
+	auto b = grd_intern(&interner, U"world"_b);
+	GRD_EXPECT(a.id != 0);
+	GRD_EXPECT(a != b);
+
+	// Interned from a different buffer.
+	char32_t buf[] = U"hello";
+	GRD_EXPECT(grd_intern(&interner, GrdUnicodeString{ buf, 5 }) == a);
+	GRD_EXPECT(grd_find_atom(&interner, U"world"_b) == b);
+	GRD_EXPECT(grd_find_atom(&interner, U"nope"_b).id == 0);
+	GRD_EXPECT(grd_atom_str(&interner, a) == U"hello"_b);
+	GRD_EXPECT(grd_atom_str(&interner, a).data != buf);
+	GRD_EXPECT_EQ(grd_atom_hash(&interner, a), grd_hash_key(U"hello"_b));
+	GRD_EXPECT_EQ(grd_len(&interner), 2);
+
+	auto empty = grd_intern(&interner, U""_b);
+	GRD_EXPECT_EQ(grd_len(grd_atom_str(&interner, empty)), 0);
+}
+
+GRD_DEDUP GrdAllocatedString interner_test_name(s64 i) {
+	return grd_sprint("name_%", i);
+}
+
+GRD_TEST_CASE(interner_threads) {
+	GrdInterner<char> interner;
+	grd_make_interner(&interner);
+	grd_defer_x(interner.free());
+
+	constexpr s64 THREADS = 4;
+	constexpr s64 STRINGS = 5000;
+
+	// Every thread interns the same strings, atoms must agree.
+	static GrdAtom atoms[THREADS][STRINGS];
+	auto proc = +[](GrdInterner<char>* interner, s64 thread_idx) {
+		for (auto i: grd_range(STRINGS)) {
+			auto name = interner_test_name(i);
+			atoms[thread_idx][i] = grd_intern(interner, name);
+			name.free();
+		}
+	};
+
+	GrdThread threads[THREADS];
+	for (auto i: grd_range(THREADS)) {
+		threads[i] = grd_start_thread(proc, &interner, i);
+	}
+	for (auto& it: threads) {
+		it.join();
+	}
+
+	GRD_EXPECT_EQ(grd_len(&interner), STRINGS);
+	bool all_match = true;
+	for (auto i: grd_range(STRINGS)) {
+		auto name = interner_test_name(i);
+		for (auto t: grd_range(THREADS)) {
+			if (atoms[t][i] != atoms[0][i]) {
+				all_match = false;
+			}
+		}
+		if (grd_atom_str(&interner, atoms[0][i]) != name) {
+			all_match = false;
+		}
+		name.free();
+	}
+	GRD_EXPECT(all_match);
+}
+
+GRD_TEST_CASE(interner_atom_keys) {
+	GrdHashMap<GrdAtom, s64> map;
+	grd_defer_x(map.free());
+	grd_put(&map, grd_intern(U"x"_b), 1);
+	grd_put(&map, grd_intern(U"y"_b), 2);
+	GRD_EXPECT_EQ(*grd_get(&map, grd_intern(U"y"_b)), 2);
+	GRD_EXPECT(grd_find_atom(U"x"_b) == grd_intern(U"x"_b));
+	GRD_EXPECT(grd_atom_str(grd_intern(U"x"_b)) == U"x"_b);
+}
@@ -0,0 +1,73 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_pool_allocator.h"
+#include "../grd_tuple.h"
+#include "../thread/grd_thread.h"
+
+struct PoolTestNode {
+	s64           value = 0;
+	PoolTestNode* next = NULL;
+	char          name[24] = {};
+};
+
+GRD_TEST_CASE(pool_reuse) {
+	auto allocator = grd_make_pool_allocator<PoolTestNode>(c_allocator, false, 1024);
+	grd_defer_x(grd_free_allocator(allocator));
+	auto pool = (GrdPool*) allocator.data;
+	GRD_EXPECT_EQ(pool->slot_size, sizeof(PoolTestNode));
+
+	PoolTestNode* nodes[200];
+	for (auto i: grd_range(200)) {
+		nodes[i] = grd_make<PoolTestNode>(allocator);
+		nodes[i]->value = i;
+	}
+	bool intact = true;
+	for (auto i: grd_range(200)) {
+		intact = intact && nodes[i]->value == i;
+	}
+	GRD_EXPECT(intact);
+	// Freed slots are handed out again, last freed first.
+	GrdFree(allocator, nodes[10]);
+	GrdFree(allocator, nodes[20]);
+	auto reused_20 = grd_make<PoolTestNode>(allocator);
+	auto reused_10 = grd_make<PoolTestNode>(allocator);
+	GRD_EXPECT_EQ(reused_20, nodes[20]);
+	GRD_EXPECT_EQ(reused_10, nodes[10]);
+	// Slots of a slab are dense.
+	GRD_EXPECT_EQ(nodes[1], nodes[0] + 1);
+}
+
+GRD_TEST_CASE(pool_threads) {
+	auto allocator = grd_make_pool_allocator(48, c_allocator, true);
+	grd_defer_x(grd_free_allocator(allocator));
+
+	auto proc = +[](GrdAllocator allocator) {
+		void* ptrs[500];
+		for (auto round: grd_range(20)) {
+			for (auto i: grd_range(500)) {
+				ptrs[i] = GrdMalloc(allocator, 48);
+				memset(ptrs[i], u8(i), 48);
+			}
+			for (auto i: grd_range(500)) {
+				if (((u8*) ptrs[i])[47] != u8(i)) {
+					grd_panic("Slot was overwritten");
+				}
+				GrdFree(allocator, ptrs[i]);
+			}
+		}
+	};
+	GrdThread threads[4];
+	for (auto& it: threads) {
+		it = grd_start_thread(proc, allocator);
+	}
+	proc(allocator);
+	for (auto& it: threads) {
+		it.join();
+	}
+	auto pool = (GrdPool*) allocator.data;
+	// Exited threads gave their caches back.
+	GRD_EXPECT(pool->caches == NULL || pool->caches->next_in_owner == NULL);
+}
@@ -0,0 +1,132 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_reflect_hash.h"
+#include "../grd_tuple.h"
+#include "../grd_hash_map.h"
+#include "../grd_format.h"
+
+struct ReflectHashPadded {
+	u8  a;
+	u64 b;
+	u16 c;
+
+	bool operator==(const ReflectHashPadded& rhs) const = default;
+
+	GRD_REFLECT_HASH(ReflectHashPadded);
+	GRD_REFLECT(ReflectHashPadded) {
+		GRD_MEMBER(a);
+		GRD_MEMBER(b);
+		GRD_MEMBER(c);
+	}
+};
+
+struct ReflectHashPacked {
+	u32 a;
+	u32 b;
+	u64 c[2];
+
+	GRD_REFLECT_HASH(ReflectHashPacked);
+	GRD_REFLECT(ReflectHashPacked) {
+		GRD_MEMBER(a);
+		GRD_MEMBER(b);
+		GRD_MEMBER(c);
+	}
+};
+
+struct ReflectHashNested: ReflectHashPacked {
+	ReflectHashPadded padded;
+	void*             ptr;
+
+	GRD_REFLECT_HASH(ReflectHashNested);
+	GRD_REFLECT(ReflectHashNested) {
+		GRD_BASE_TYPE(ReflectHashPacked);
+		GRD_MEMBER(padded);
+		GRD_MEMBER(ptr);
+	}
+};
+
+// Not opted in, and derived structs don't inherit it.
+struct ReflectHashOwning {
+	GrdSpan<s32> items;
+
+	GRD_REFLECT(ReflectHashOwning) {
+		GRD_MEMBER(items);
+	}
+};
+
+struct ReflectHashDerived: ReflectHashPadded {
+	GRD_REFLECT(ReflectHashDerived) {
+		GRD_BASE_TYPE(ReflectHashPadded);
+	}
+};
+
+static_assert(GrdGlobalHashable<ReflectHashPadded>);
+static_assert(!GrdGlobalHashable<ReflectHashOwning>);
+static_assert(!GrdGlobalHashable<ReflectHashDerived>);
+
+GRD_TEST_CASE(reflect_hash_skips_padding) {
+	ReflectHashPadded x;
+	ReflectHashPadded y;
+	memset(&x, 0xaa, sizeof(x));
+	memset(&y, 0x55, sizeof(y));
+	x.a = y.a = 1;
+	x.b = y.b = 2;
+	x.c = y.c = 3;
+	GRD_EXPECT_EQ(grd_hash64(x), grd_hash64(y));
+
+	auto h = grd_make_hasher();
+	grd_update(&h, x.a);
+	grd_update(&h, x.b);
+	grd_update(&h, x.c);
+	GRD_EXPECT_EQ(grd_hash64(x), grd_hash64(&h));
+
+	y.c = 4;
+	GRD_EXPECT(grd_hash64(x) != grd_hash64(y));
+	GRD_EXPECT_EQ(grd_reflect_hash_plan<ReflectHashPadded>()->size, 11);
+}
+
+GRD_TEST_CASE(reflect_hash_fuses_members) {
+	GRD_EXPECT_EQ(grd_reflect_hash_plan<ReflectHashPacked>()->runs.count, 1);
+
+	// Base members and the first padded member are adjacent.
+	auto plan = grd_reflect_hash_plan<ReflectHashNested>();
+	GRD_EXPECT_EQ(plan->runs.count, 3);
+	GRD_EXPECT_EQ(plan->size, 24 + 11 + 8);
+
+	ReflectHashNested n = {};
+	n.a = 1;
+	n.c[1] = 2;
+	n.padded.b = 3;
+	n.ptr = &n;
+	auto h = grd_make_hasher();
+	grd_update(&h, &n, 24);
+	grd_update(&h, n.padded.a);
+	grd_update(&h, n.padded.b);
+	grd_update(&h, n.padded.c);
+	grd_update(&h, n.ptr);
+	GRD_EXPECT_EQ(grd_hash64(n), grd_hash64(&h));
+}
+
+GRD_TEST_CASE(reflect_hash_tuple_keys) {
+	s32 x;
+	GrdTuple<s32*, u32> key = { &x, 7 };
+	auto h = grd_make_hasher();
+	grd_update(&h, key._0);
+	grd_update(&h, key._1);
+	GRD_EXPECT_EQ(grd_hash64(key), grd_hash64(&h));
+
+	GrdHashMap<GrdTuple<s32*, u32>, s32> map;
+	grd_defer_x(map.free());
+	grd_put(&map, key, 1);
+	grd_put(&map, GrdTuple<s32*, u32>{ &x, 8 }, 2);
+	GRD_EXPECT_EQ(*grd_get(&map, key), 1);
+	GRD_EXPECT_EQ(grd_len(map), 2);
+
+	GrdHashMap<ReflectHashPadded, s32> struct_map;
+	grd_defer_x(struct_map.free());
+	grd_put(&struct_map, ReflectHashPadded{ 1, 2, 3 }, 5);
+	GRD_EXPECT_EQ(*grd_get(&struct_map, ReflectHashPadded{ 1, 2, 3 }), 5);
+}
@@ -0,0 +1,63 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_small_array.h"
+#include "../grd_tracker_allocator.h"
+
+s64 small_array_test_sum(GrdSpan<s64> span) {
+	s64 sum = 0;
+	for (auto it: span) {
+		sum += it;
+	}
+	return sum;
+}
+
+GRD_TEST_CASE(small_array_inline) {
+	auto tracker = grd_make_tracker_allocator(c_allocator);
+	grd_defer_x(grd_free_allocator(tracker));
+	auto ta = grd_get_tracker_allocator(tracker);
+
+	GrdSmallArray<s64, 4> arr = { tracker };
+	grd_add(&arr, { 1, 2, 3 });
+	grd_add(&arr, 0, 0);
+	GRD_EXPECT(arr.is_inline());
+	GRD_EXPECT_EQ(grd_len(&ta->allocations), 0);
+	GRD_EXPECT_EQ(arr[0], 0);
+	GRD_EXPECT_EQ(arr[-1], 3);
+	GRD_EXPECT_EQ(small_array_test_sum(arr), 6);
+	GRD_EXPECT(grd_contains(arr, s64(2)));
+
+	grd_remove(&arr, 0);
+	GRD_EXPECT_EQ(grd_len(arr), 3);
+	GRD_EXPECT_EQ(arr[0], 1);
+
+	// Copies of inline items point to their own storage.
+	auto copy = arr;
+	copy[0] = 10;
+	GRD_EXPECT(copy.is_inline());
+	GRD_EXPECT_EQ(arr[0], 1);
+	GRD_EXPECT_EQ(small_array_test_sum(copy), 15);
+}
+
+GRD_TEST_CASE(small_array_spills) {
+	auto tracker = grd_make_tracker_allocator(c_allocator);
+	grd_defer_x(grd_free_allocator(tracker));
+	auto ta = grd_get_tracker_allocator(tracker);
+
+	GrdSmallArray<s64, 2> arr = { tracker };
+	for (auto i: grd_range(100)) {
+		grd_add(&arr, i);
+	}
+	GRD_EXPECT(!arr.is_inline());
+	GRD_EXPECT_EQ(grd_len(&ta->allocations), 1);
+	GRD_EXPECT_EQ(small_array_test_sum(arr), 99 * 100 / 2);
+	GRD_EXPECT(arr.capacity >= 100);
+
+	arr.free();
+	GRD_EXPECT(arr.is_inline());
+	GRD_EXPECT_EQ(grd_len(&ta->allocations), 0);
+	grd_add(&arr, 7);
+	GRD_EXPECT_EQ(arr[0], 7);
+}
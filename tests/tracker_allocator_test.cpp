@@ -0,0 +1,64 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_tracker_allocator.h"
+#include "../grd_format.h"
+
+GRD_TEST_CASE(tracker_allocator_usage) {
+	auto allocator = grd_make_tracker_allocator();
+	auto ta = grd_get_tracker_allocator(allocator);
+	void* a = GrdMalloc(allocator, 100);
+	void* b = GrdMalloc(allocator, 28);
+	GRD_EXPECT_EQ(ta->memory_usage, 128);
+	b = GrdRealloc(allocator, b, 28, 56);
+	GRD_EXPECT_EQ(ta->memory_usage, 156);
+	GrdFree(allocator, a);
+	GrdFree(allocator, b);
+	GRD_EXPECT_EQ(ta->memory_usage, 0);
+	GRD_EXPECT(grd_tracker_allocator_is_empty(allocator));
+	grd_free_allocator(allocator);
+}
+
+GRD_TEST_CASE(tracker_sampling_estimate) {
+	auto allocator = grd_make_tracker_allocator(c_allocator, 64 * 1024);
+	grd_defer_x(grd_free_allocator(allocator));
+	auto ta = grd_get_tracker_allocator(allocator);
+
+	constexpr s64 count = 100'000;
+	auto ptrs = GrdAlloc<void*>(c_allocator, count);
+	grd_defer_x(GrdFree(c_allocator, ptrs));
+	for (auto i: grd_range(count)) {
+		ptrs[i] = GrdMalloc(allocator, 1000);
+	}
+	// About 1500 samples, the estimate is within a few percent.
+	f64 expected = count * 1000;
+	GRD_EXPECT(grd_len(&ta->allocations) < count / 10);
+	GRD_EXPECT(ta->memory_usage > expected * 0.85 && ta->memory_usage < expected * 1.15);
+
+	for (auto i: grd_range(count)) {
+		ptrs[i] = GrdRealloc(allocator, ptrs[i], 1000, 2000);
+	}
+	expected = count * 2000;
+	GRD_EXPECT(ta->memory_usage > expected * 0.85 && ta->memory_usage < expected * 1.15);
+
+	for (auto i: grd_range(count)) {
+		GrdFree(allocator, ptrs[i]);
+	}
+	GRD_EXPECT_EQ(ta->memory_usage, 0);
+	GRD_EXPECT(grd_tracker_allocator_is_empty(allocator));
+}
+
+GRD_TEST_CASE(tracker_sampling_large_allocations) {
+	auto allocator = grd_make_tracker_allocator(c_allocator, 64 * 1024);
+	grd_defer_x(grd_free_allocator(allocator));
+	auto ta = grd_get_tracker_allocator(allocator);
+
+	// Allocations much larger than the period are always sampled with their own size.
+	void* a = GrdMalloc(allocator, 16 * 1024 * 1024);
+	GRD_EXPECT_EQ(grd_len(&ta->allocations), 1);
+	GRD_EXPECT_EQ(ta->memory_usage, 16 * 1024 * 1024);
+	GrdFree(allocator, a);
+	GRD_EXPECT_EQ(ta->memory_usage, 0);
+}
@@ -0,0 +1,71 @@
+#if 0
+	`dirname "$0"`/../build.sh $0 $@; exit
+#endif
+
+#include "../grd_testing.h"
+#include "../grd_tree_hash.h"
+#include <stdio.h>
+
+GRD_DEDUP u8* tree_hash_test_data(u64 size) {
+	auto data = GrdAlloc<u8>(c_allocator, size);
+	for (auto i: grd_range(size)) {
+		data[i] = u8((i * 2654435761) >> 13);
+	}
+	return data;
+}
+
+GRD_TEST_CASE(tree_hash_threads_and_stream_agree) {
+	for (u64 size: { 0ull, 1ull, GRD_TREE_HASH_CHUNK_SIZE, GRD_TREE_HASH_CHUNK_SIZE + 1, 5 * GRD_TREE_HASH_CHUNK_SIZE + 777 }) {
+		auto data = tree_hash_test_data(size);
+		grd_defer_x(GrdFree(c_allocator, data));
+
+		auto single = grd_tree_hash128(data, size, 1);
+		GRD_EXPECT(grd_tree_hash128(data, size, 4) == single);
+
+		// Odd sized updates cross chunk boundaries.
+		auto h = grd_make_tree_hasher();
+		for (u64 offset = 0; offset < size; offset += 100'003) {
+			grd_update(&h, data + offset, grd_min(size - offset, 100'003ull));
+		}
+		GRD_EXPECT(grd_hash128(&h) == single);
+	}
+}
+
+GRD_TEST_CASE(tree_hash_digests_are_distinct) {
+	u64  size = 2 * GRD_TREE_HASH_CHUNK_SIZE;
+	auto data = tree_hash_test_data(size);
+	grd_defer_x(GrdFree(c_allocator, data));
+
+	auto a = grd_tree_hash128(data, size);
+	GRD_EXPECT(!(grd_tree_hash128(data, size - 1) == a));
+	data[GRD_TREE_HASH_CHUNK_SIZE + 5] ^= 1;
+	GRD_EXPECT(!(grd_tree_hash128(data, size) == a));
+	GRD_EXPECT(!(grd_tree_hash128(NULL, 0) == a));
+
+	// Swapped chunks must not collide.
+	auto b = tree_hash_test_data(size);
+	grd_defer_x(GrdFree(c_allocator, b));
+	memcpy(b, data + GRD_TREE_HASH_CHUNK_SIZE, GRD_TREE_HASH_CHUNK_SIZE);
+	memcpy(b + GRD_TREE_HASH_CHUNK_SIZE, data, GRD_TREE_HASH_CHUNK_SIZE);
+	GRD_EXPECT(!(grd_tree_hash128(b, size) == grd_tree_hash128(data, size)));
+}
+
+GRD_TEST_CASE(tree_hash_file) {
+	auto path = U"tree_hash_test.bin"_b;
+	u64  size = 3 * GRD_TREE_HASH_CHUNK_SIZE + 10;
+	auto data = tree_hash_test_data(size);
+	grd_defer_x(GrdFree(c_allocator, data));
+
+	auto [file, e] = grd_open_file(path, GRD_FILE_WRITE | GRD_FILE_CREATE_NEW);
+	GRD_EXPECT(!e);
+	GRD_EXPECT(!grd_write_file(&file, data, size));
+	grd_close_file(&file);
+
+	auto [digest, e2] = grd_tree_hash_file(path);
+	GRD_EXPECT(!e2);
+	GRD_EXPECT(digest == grd_tree_hash128(data, size));
+
+	auto [missing, e3] = grd_tree_hash_file(U"tree_hash_test_missing.bin"_b);
+	GRD_EXPECT(e3);
+	remove("tree_hash_test.bin");
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "../grd_base.h"
+#include "../grd_scoped.h"
+#include "../sync/grd_mutex.h"
+
+// Per-thread caches of allocators like GrdPool and GrdHeap.
+// A thread has a cache for every allocator it used, kept in a thread_local
+//   list per cache type, the last used one first.
+// The allocator keeps a list of its caches too, guarded by a mutex of its choice.
+// When the thread exits, every cache is passed to grd_free_thread_cache(Cache*),
+//   which the allocator defines for its cache type.
+
+// Cache types derive from it.
+template <typename Owner, typename Cache>
+struct GrdThreadCacheLinks {
+	Owner* owner = NULL;
+	Cache* next_in_thread = NULL;
+	Cache* prev_in_owner = NULL;
+	Cache* next_in_owner = NULL;
+};
+
+template <typename Cache>
+struct GrdThreadCaches {
+	Cache* first = NULL;
+	bool   destroyed = false;
+
+	~GrdThreadCaches() {
+		auto cache = first;
+		while (cache) {
+			auto next = cache->next_in_thread;
+			grd_free_thread_cache(cache);
+			cache = next;
+		}
+		first = NULL;
+		destroyed = true;
+	}
+};
+
+// Not a thread_local variable template, GCC doesn't destroy those at thread exit.
+template <typename Cache>
+GRD_DEDUP GrdThreadCaches<Cache>* grd_thread_caches() {
+	static thread_local GrdThreadCaches<Cache> caches;
+	return &caches;
+}
+
+// Returns the calling thread's cache of |owner|, |make| allocates it on first use,
+//   it's then added to |*owner_caches| under |mutex|.
+// Returns NULL once the thread's caches are destroyed at thread exit.
+template <typename Cache, typename Owner>
+GRD_DEDUP Cache* grd_get_thread_cache(Owner* owner, Cache** owner_caches, GrdMutex* mutex, auto make) {
+	auto caches = grd_thread_caches<Cache>();
+	auto cache = caches->first;
+	if (cache && cache->owner == owner) {
+		return cache;
+	}
+	if (caches->destroyed) {
+		return NULL;
+	}
+	// Move the found cache to the front.
+	Cache* prev = NULL;
+	while (cache) {
+		if (cache->owner == owner) {
+			prev->next_in_thread = cache->next_in_thread;
+			cache->next_in_thread = caches->first;
+			caches->first = cache;
+			return cache;
+		}
+		prev = cache;
+		cache = cache->next_in_thread;
+	}
+	cache = make();
+	cache->owner = owner;
+	{
+		GrdScopedLock(*mutex);
+		cache->next_in_owner = *owner_caches;
+		if (*owner_caches) {
+			(*owner_caches)->prev_in_owner = cache;
+		}
+		*owner_caches = cache;
+	}
+	cache->next_in_thread = caches->first;
+	caches->first = cache;
+	return cache;
+}
+
+// Removes |cache| from |*owner_caches|, the thread's list still has it.
+template <typename Cache>
+GRD_DEDUP void grd_unlink_thread_cache(Cache* cache, Cache** owner_caches, GrdMutex* mutex) {
+	GrdScopedLock(*mutex);
+	if (cache->prev_in_owner) {
+		cache->prev_in_owner->next_in_owner = cache->next_in_owner;
+	} else {
+		*owner_caches = cache->next_in_owner;
+	}
+	if (cache->next_in_owner) {
+		cache->next_in_owner->prev_in_owner = cache->prev_in_owner;
+	}
+}
+
+// Removes the calling thread's cache of |owner| from the thread's list, for freeing |owner|.
+// Returns the cache or NULL if the thread has none.
+template <typename Cache, typename Owner>
+GRD_DEDUP Cache* grd_forget_thread_cache(Owner* owner) {
+	Cache** link = &grd_thread_caches<Cache>()->first;
+	while (*link) {
+		if ((*link)->owner == owner) {
+			auto cache = *link;
+			*link = cache->next_in_thread;
+			return cache;
+		}
+		link = &(*link)->next_in_thread;
+	}
+	return NULL;
+}
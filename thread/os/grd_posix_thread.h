@@ -13,6 +13,11 @@ GRD_DEDUP GrdThreadId grd_current_thread_id() {
 	return pthread_self();
 }
 
+GRD_DEDUP s64 grd_os_processor_count() {
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? count : 1;
+}
+
 using GrdOsThread = pthread_t;
 using GrdOsThreadReturnType = void*;
 
@@ -13,6 +13,10 @@ GRD_DEDUP GrdThreadId grd_current_thread_id() {
 	return (GrdThreadId) GetCurrentThreadId();
 }
 
+GRD_DEDUP s64 grd_os_processor_count() {
+	return GetActiveProcessorCount(GRD_WIN_ALL_PROCESSOR_GROUPS);
+}
+
 using GrdOsThread = GRD_WIN_HANDLE;
 using GrdOsThreadReturnType = GRD_WIN_DWORD;
 